@@ -2,6 +2,7 @@
 
 
 #include "C_Generate.h"
+#include "Async/Async.h"
 
 // Sets default values
 AC_Generate::AC_Generate()
@@ -9,34 +10,24 @@ AC_Generate::AC_Generate()
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	//Creates Meshes for each location
-	m_MaxNumRooms = 20;
+	//Creates the mesh the rooms are drawn with
 	CreateMeshes();
 
 	m_NewSeed = false;
 	m_NumberRooms = 3;
-	float marginIncrement = 2500;
-
-	m_Margin = marginIncrement * m_NumberRooms;
 	m_pGraph = CreateDefaultSubobject<UC_Graph>(TEXT("TriangulationGraph"));
 }
 
 void AC_Generate::CreateMeshes()
 {
-	for (int32 number{ 0 }; number < m_MaxNumRooms; ++number)
+	//one instanced mesh for all the rooms, the instances are added once the rooms are placed
+	m_pRoomInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("RoomInstances"));
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> MeshAsset(TEXT("StaticMesh'/Engine/BasicShapes/Cube.Cube'"));
+	if (MeshAsset.Succeeded())
 	{
-		//turns to FString
-		FString IntAsString = FString::Printf(TEXT("%d"), number);
-
-		// Create the name for the UStaticMeshComponent with the int32 value from the loop.
-		FString actorComponentName = FString::Printf(TEXT("Dungeon%s"), *IntAsString);
-
-		//Creates a Dungeon objects
-		UC_Dungeon* newDungeon = CreateDefaultSubobject<UC_Dungeon>(*actorComponentName);
-
-		//Adds To Array
-		m_pDungeonArray.Add(newDungeon);
+		m_pRoomInstances->SetStaticMesh(MeshAsset.Object);
 	}
+	SetRootComponent(m_pRoomInstances);
 }
 
 
@@ -49,7 +40,19 @@ void AC_Generate::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedE
 		// code here to react to changes in m_NumberRooms during gameplay
 		SetCells();
 		UE_LOG(LogTemp, Warning, TEXT("m_NumberRooms was changed to %d"), m_NumberRooms);
-		UE_LOG(LogTemp, Warning, TEXT("New Seed Number was changed to %d"), m_Seed);
+		UE_LOG(LogTemp, Warning, TEXT("New Seed Number was changed to %lld"), m_Seed);
+	}
+
+	if (PropertyNumberRooms == GET_MEMBER_NAME_CHECKED(AC_Generate, m_PlacementMode))
+	{
+		// regenerate with the other placement mode
+		SetCells();
+	}
+
+	if (PropertyNumberRooms == GET_MEMBER_NAME_CHECKED(AC_Generate, m_LoopEdgeRatio))
+	{
+		// regenerate with more or fewer loops
+		SetCells();
 	}
 
 	FName PropertyNewSeed = (PropertyChangedEvent.Property != nullptr) ? PropertyChangedEvent.Property->GetFName() : NAME_None;
@@ -58,7 +61,7 @@ void AC_Generate::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedE
 	{
 		// code here to react to changes in m_NewSeed during gameplay
 		SetCells();
-		UE_LOG(LogTemp, Warning, TEXT("New Seed Number was changed to %d"), m_Seed);
+		UE_LOG(LogTemp, Warning, TEXT("New Seed Number was changed to %lld"), m_Seed);
 		m_NewSeed = false;
 	}
 
@@ -83,127 +86,215 @@ void AC_Generate::BeginPlay()
 		m_pGrid = Cast<AC_Grid>(FoundActors[0]);
 }
 
+void AC_Generate::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	m_bCancelAsync = true;
+	if (m_AsyncSlice.IsValid())
+		m_AsyncSlice.Wait();
+	m_bAsyncRunning = false;
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AC_Generate::SetCells()
 {
-	// Loop over all the dungeons, and hide them in game (insivible) (bHiddenInGame = true)
-	for (UC_Dungeon* d : m_pDungeonArray)
+	//Get Seed, a full 64 bits of it
+	const FGuid guid = FGuid::NewGuid();
+	GenerateFromSeed(static_cast<int64>((static_cast<uint64>(guid.A) << 32) | guid.B));
+}
+
+void AC_Generate::GenerateFromSeed(int64 seed)
+{
+	//the grid is found in BeginPlay, there is nothing to generate on before it
+	if (m_pGrid == nullptr)
+		return;
+
+	const uint64 coreSeed = static_cast<uint64>(seed);
+	const DungeonCore::GenerationParams params = MakeParams();
+
+	SetLayoutCacheDirectory();
+
+	DungeonCore::LayoutView cachedLayout;
+	if (m_bUseLayoutCache && m_LayoutCache.Find(params, coreSeed, cachedLayout))
 	{
-		d->SetVisibility(true);
+		//rooms and corridors come straight from the mapped file
+		m_Seed = seed;
+		m_GenerationStats = DungeonCore::GenerationStats();
+		m_pRoomInstances->ClearInstances();
+		m_pGrid->EmptyCells();
+
+		std::vector<DungeonCore::Room> rooms;
+		DungeonCore::ApplyLayout(cachedLayout, m_pGrid->GetCoreGrid(), rooms);
+		ShowRooms(rooms);
+		m_pGrid->ShowCorridors();
+
+		//the triangulation isn't cached, so a cached dungeon has no graph to debug draw
+		m_pGraph->DeletePoints();
+		OnDungeonGenerated.Broadcast(m_Seed);
+		return;
 	}
 
-	//Empty Ce;;
-	if (m_pGrid->GetArraySize() > 0)
-		m_pGrid->EmptyCells();
+	//the same stages as the async generation, DungeonBench and DungeonBatch, run to the end right here
+	DungeonCore::Generator& generator = PrepareGenerator(m_pGenerator, m_ParamsKey, &m_StatsSink);
+	generator.SetExecutor(m_pGrid->GetCorridorExecutor());
+	generator.Generate(coreSeed);
+	ShowGeneratedDungeon(generator);
+}
 
-	//Get Seed
-	m_Seed = FMath::RandRange(0, 1000 - 1);
-	//GetRandomStream based on new Seed
-	FRandomStream RandomStream(m_Seed);
-
-	int32 nrRows = 100;
-	int32 nrColumns = 100;
-	int32 minPosition = 0;
-	int32 lenght = 100;
-	int32 maxPosition = nrColumns * lenght;
-
-	int32 minSize = 300;
-	int32 maxSize = 600;
-	
-	//go over all the number desirable of rooms
-	for (int32 i{ 0 }; i < m_NumberRooms; ++i)
+DungeonCore::Generator& AC_Generate::PrepareGenerator(TUniquePtr<DungeonCore::Generator>& pGenerator, uint64& paramsKey, DungeonCore::StatsSink* pSink)
+{
+	//the generator keeps its grid between runs, only a new size or new params need a new one
+	const DungeonCore::GenerationParams params = MakeParams();
+	const uint64 key = DungeonCore::GetLayoutKey(params, 0);
+	if (!pGenerator.IsValid() || paramsKey != key)
 	{
-		//while overlap is true, run. if not, skip to next index
-		bool bOverlap = false;
-		do
-		{
-			//Random center given 0, lowest x and y, and maxPosition, highest x and y (since width and depth are the same value, and we have nrRows = nrColumns
-			FVector randomCenter = FVector(RandomStream.FRandRange(minPosition, maxPosition), RandomStream.FRandRange(minPosition, maxPosition), 0);
-			
-			//get a random width
-			int32 width = RandomStream.RandRange(minSize, maxSize);
-			//get random depth
-			int32 depth = RandomStream.RandRange(minSize, maxSize);
-
-			//find cell index at random center
-			int32 index = m_pGrid->GetCellIndex(randomCenter);
-			//Get cell at given index
-			FCell* cell = m_pGrid->GetCellAtIndex(index);
-			//assign its index to itself
-			cell->_index = index;
-
-			//new center == cell center
-			FVector center = FVector(cell->_center.X, cell->_center.Y, cell->_center.Z);
-
-			bOverlap = false;
-			//loop over existing dungeons in dungeon array
-			for (const UC_Dungeon* ExistingDungeon : m_pDungeonArray)
-			{
-				//if current cell is not itself
-				if (ExistingDungeon != m_pDungeonArray[i])
-				{
+		pGenerator = MakeUnique<DungeonCore::Generator>(params);
+		pGenerator->SetStatsSink(pSink);
+		paramsKey = key;
+	}
+
+	//the costs aren't part of the params, the walls and weights set on the grid on screen have to be copied over
+	pGenerator->CopyCellCosts(m_pGrid->GetCoreGrid());
+	return *pGenerator;
+}
 
-					float margin = 200.0f;
-					//this circle radius will define an area in which a new dungeon cannot be placed
-					float circleRadius = maxSize + margin;
-					
+bool AC_Generate::ShowGeneratedDungeon(const DungeonCore::Generator& generator)
+{
+	//the whole swap happens in this call, so no frame shows half of each dungeon
+	if (!m_pGrid->ShowGeneratedCells(generator.GetGrid()))
+		return false;
+
+	const DungeonCore::DungeonLayout& layout = generator.GetLayout();
+	m_Seed = static_cast<int64>(layout.seed);
+	m_GenerationStats = generator.GetStats();
+	m_pRoomInstances->ClearInstances();
+	ShowRooms(layout.rooms);
+	m_pGraph->SetCoreGraph(generator.GetGraph());
+
+	if (!layout.allRoomsPlaced)
+	{
+		//the grid is too crowded, the layout is built from the rooms that fit
+		UE_LOG(LogTemp, Warning, TEXT("Only %d of %d rooms fit on the grid (seed %lld)"), static_cast<int32>(layout.rooms.size()), generator.GetParams().numberRooms, m_Seed);
+	}
 
-					// Define the point you want to check
-					FVector PointToCheck = ExistingDungeon->m_Center;
+	//keep the result for the next time this seed comes up
+	SetLayoutCacheDirectory();
+	if (m_bUseLayoutCache)
+		m_LayoutCache.Store(generator.GetParams(), layout.seed, layout.rooms, layout.allRoomsPlaced, generator.GetGraph(), generator.GetGrid());
 
-					// Calculate the squared distance between the circle's center and the point
-					float SquaredDistance = FVector::DistSquared(center, PointToCheck);
+	OnDungeonGenerated.Broadcast(m_Seed);
+	return true;
+}
 
-					// Compare the squared distance to the squared radius
-					float SquaredRadius = circleRadius * circleRadius;
-					if (SquaredDistance <= SquaredRadius)
-					{
-						bOverlap = true;
-						break;
-					}
-				}
+DungeonCore::GenerationParams AC_Generate::MakeParams() const
+{
+	const DungeonCore::Grid& grid = m_pGrid->GetCoreGrid();
+	DungeonCore::GenerationParams params;
+	params.numberRooms = m_NumberRooms;
+	params.placementMode = m_PlacementMode == EPlacementMode::PoissonDisk ? DungeonCore::PlacementMode::PoissonDisk : DungeonCore::PlacementMode::Rejection;
+	params.nrRows = grid.GetNrRows();
+	params.nrColumns = grid.GetNrColumns();
+	params.cellWidth = grid.GetCellWidth();
+	params.cellDepth = grid.GetCellDepth();
+	params.corridorCostScale = m_pGrid->m_CorridorCostScale;
+	params.corridorSearch = m_pGrid->GetCorePathSearch();
+	params.loopEdgeRatio = m_LoopEdgeRatio;
+	return params;
+}
 
+void AC_Generate::SetLayoutCacheDirectory()
+{
+	if (m_LayoutCache.GetDirectory().empty())
+		m_LayoutCache.SetDirectory(TCHAR_TO_UTF8(*FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DungeonCache")))));
+}
 
-			}
+void AC_Generate::ShowRooms(const std::vector<DungeonCore::Room>& rooms)
+{
+	m_RoomTransforms.Reset(static_cast<int32>(rooms.size()));
+	for (const DungeonCore::Room& room : rooms)
+	{
+		m_RoomTransforms.Add(FTransform(FRotator::ZeroRotator, ToFVector(room.center), FVector{ room.width / 100.0f, room.depth / 100.0f, 1.0f }));
+	}
+	m_pRoomInstances->AddInstances(m_RoomTransforms, false);
+}
+
+bool AC_Generate::GenerateAsync(int64 seed, bool bCommitWhenDone)
+{
+	if (m_bAsyncRunning || m_pGrid == nullptr)
+		return false;
+
+	PrepareGenerator(m_pAsyncGenerator, m_AsyncParamsKey, &m_AsyncStatsSink).Begin(static_cast<uint64>(seed));
+	m_bCancelAsync = false;
+	m_bAsyncRunning = true;
+	m_bAsyncReady = false;
+	m_bCommitWhenDone = bCommitWhenDone;
+	return true;
+}
 
-			if (bOverlap != true)
+void AC_Generate::TickAsyncGeneration()
+{
+	if (!m_bAsyncRunning)
+		return;
+
+	//one slice at a time, the next one starts the frame after the last one is done
+	if (m_AsyncSlice.IsValid())
+	{
+		if (!m_AsyncSlice.IsReady())
+			return;
+		m_AsyncSlice.Reset();
+	}
+
+	if (m_pAsyncGenerator->IsDone())
+	{
+		m_bAsyncRunning = false;
+		m_bAsyncReady = true;
+		if (m_bCommitWhenDone)
+			CommitGeneratedDungeon();
+		return;
+	}
+
+	DungeonCore::Generator* pGenerator = m_pAsyncGenerator.Get();
+	FThreadSafeBool* pCancel = &m_bCancelAsync;
+	const double budgetMs = m_AsyncFrameBudgetMs;
+	m_AsyncSlice = Async(EAsyncExecution::ThreadPool, [pGenerator, pCancel, budgetMs]()
+		{
+			if (budgetMs > 0.0)
 			{
-				if (!cell->isEmpty())
-				{
-					bOverlap = true;
-					break;
-				}
-
-				cell->SetFull();
-				//give the static mesh in dungeon its position, width and depth
-				m_pDungeonArray[i]->SetVariables(center, width, depth);
-				//make it visible (notHidden) for render
-				m_pDungeonArray[i]->SetVisibility(false);
-				break;
+				pGenerator->Step(budgetMs);
+				return;
 			}
 
-		} while (bOverlap);
+			//no budget, run to the end but still stop soon after a cancel
+			while (!*pCancel && !pGenerator->Step(10.0))
+			{
+			}
+		});
+}
 
-	}
+bool AC_Generate::CommitGeneratedDungeon()
+{
+	if (!m_bAsyncReady || m_pGrid == nullptr)
+		return false;
+	m_bAsyncReady = false;
 
-	int32 radiusSuperTriangle = 5000;
-	if (m_pGraph->m_Locations.Num() > 0)
-		m_pGraph->DeletePoints();
-	m_pGraph->CreateSuperTriangle(radiusSuperTriangle, m_NumberRooms, m_Margin);
+	const DungeonCore::DungeonLayout& layout = m_pAsyncGenerator->GetLayout();
 
-	//points for triangulation will be the dungeons center
-	for (int32 j{ 0 }; j < m_NumberRooms; ++j)
+	//the grid was resized or changed settings while the dungeon was generated, its rooms and corridors belong to the old one.
+	//the dungeon on screen stays, the same seed starts over on the new grid and is committed when done
+	if (DungeonCore::GetLayoutKey(MakeParams(), 0) != m_AsyncParamsKey || !ShowGeneratedDungeon(*m_pAsyncGenerator))
 	{
-		m_pGraph->AddPoint(m_pDungeonArray[j]->m_Center);
+		UE_LOG(LogTemp, Warning, TEXT("The grid changed during the async generation of seed %lld, generating it again"), static_cast<int64>(layout.seed));
+		GenerateAsync(static_cast<int64>(layout.seed), true);
+		return false;
 	}
-
-	//run triangulation algorithm
-	m_pGraph->TriangulationAlgorithm();
+	return true;
 }
 
 // Called every frame
 void AC_Generate::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	TickAsyncGeneration();
 	DrawDebugFunctions();
 }
 
@@ -12,11 +12,26 @@
 #include "Components/StaticMeshComponent.h" // Include the StaticMeshComponent header.
 #include "DataTypes.h"
 #include "C_Grid.h"
-#include "C_Dungeon.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "C_Graph.h"
+#include "DungeonStats.h"
+#include "Async/Future.h"
+#include "HAL/ThreadSafeBool.h"
+#include "DungeonCore/Generator.h"
+#include "DungeonCore/LayoutCache.h"
 
 #include "C_Generate.generated.h"
 
+//how the rooms are spread over the grid, mirrors DungeonCore::PlacementMode
+UENUM(BlueprintType)
+enum class EPlacementMode : uint8
+{
+    Rejection UMETA(DisplayName = "Random rejection"),
+    PoissonDisk UMETA(DisplayName = "Poisson disk")
+};
+
+//fired on the game thread once a dungeon is on screen, with the seed it was built from
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDungeonGenerated, int64, Seed);
 
 
 UCLASS()
@@ -33,9 +48,53 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Seed")
         bool m_NewSeed = false;
 
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Number of Rooms", meta = (ClampMin = "3", ClampMax = "20"))
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Number of Rooms", meta = (ClampMin = "3", ClampMax = "10000", UIMax = "200"))
     int32 m_NumberRooms;
 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Number of Rooms")
+    EPlacementMode m_PlacementMode = EPlacementMode::Rejection;
+
+    //fraction of the triangulation edges outside the MST that still get a corridor, 0 keeps the dungeon a tree
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Corridors", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float m_LoopEdgeRatio = 0.f;
+
+    //seed of the dungeon on screen. send it to rebuild the same dungeon elsewhere with GenerateFromSeed
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Seed")
+    int64 m_Seed = 0;
+
+    //builds the dungeon of this seed, the same one on every machine and in DungeonBench
+    UFUNCTION(BlueprintCallable, Category = "Seed")
+    void GenerateFromSeed(int64 seed);
+
+    //time and allocations of each stage of the last generated dungeon, all zero after a cache hit.
+    //the allocation counts are process wide and the bytes aren't tracked in the engine, see FDungeonStatsSink
+    const DungeonCore::GenerationStats& GetGenerationStats() const { return m_GenerationStats; }
+
+    //Builds the dungeon of this seed on a background thread while the current one stays on screen.
+    //When it is done the rooms and corridors are swapped in during one Tick, right away or, without bCommitWhenDone,
+    //on the next CommitGeneratedDungeon. Returns false if another async generation is still running
+    UFUNCTION(BlueprintCallable, Category = "Async")
+    bool GenerateAsync(int64 seed, bool bCommitWhenDone = true);
+
+    //shows the dungeon a finished GenerateAsync held back. false if there is none, or if the grid was resized since:
+    //the same seed is then generated again on the new grid and committed when done
+    UFUNCTION(BlueprintCallable, Category = "Async")
+    bool CommitGeneratedDungeon();
+
+    UFUNCTION(BlueprintPure, Category = "Async")
+    bool IsGeneratingAsync() const { return m_bAsyncRunning; }
+
+    //time an async generation may take each frame, in ms of a background thread. 0 runs it start to end without pausing
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Async", meta = (ClampMin = "0.0", UIMax = "16.0"))
+    float m_AsyncFrameBudgetMs = 2.f;
+
+    UPROPERTY(BlueprintAssignable, Category = "Async")
+    FOnDungeonGenerated OnDungeonGenerated;
+
+    //loads dungeons built before from Saved/DungeonCache instead of generating them again, and stores the new ones there
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cache")
+    bool m_bUseLayoutCache = false;
+
     //UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DrawDebug")
     //    bool m_DrawDebug = false;
 
@@ -54,6 +113,8 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	//waits for the async generation, it works on memory this actor owns
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
 	// Called every frame
@@ -65,11 +126,43 @@ private:
     void SetCells();
     void DrawDebugFunctions() const;
 
-    int32 m_MaxNumRooms;
-    int32 m_Seed = 0;
-    int32 m_Margin = 0;
+    //the params the generation runs with, read from this actor and the grid
+    DungeonCore::GenerationParams MakeParams() const;
+    //Saved/DungeonCache, set on first use
+    void SetLayoutCacheDirectory();
+    //one instance per room at its position, width and depth, added in a single call
+    void ShowRooms(const std::vector<DungeonCore::Room>& rooms);
+    //creates the generator when there is none or the params changed since, and copies the grid's cell costs into it
+    DungeonCore::Generator& PrepareGenerator(TUniquePtr<DungeonCore::Generator>& pGenerator, uint64& paramsKey, DungeonCore::StatsSink* pSink);
+    //puts the generator's last dungeon on screen, the graph for the debug drawing and the cache included. false, with nothing changed,
+    //if the generator's grid doesn't have the size of the one on screen
+    bool ShowGeneratedDungeon(const DungeonCore::Generator& generator);
+    //starts the next slice of the async generation, or commits it once it is done
+    void TickAsyncGeneration();
 
     AC_Grid* m_pGrid = nullptr;
     UC_Graph* m_pGraph = nullptr;
-    TArray<UC_Dungeon*> m_pDungeonArray;
+
+    //every room is one instance, sized by the layout at runtime
+    UPROPERTY(VisibleAnywhere, Category = "Rooms")
+    UInstancedStaticMeshComponent* m_pRoomInstances = nullptr;
+    TArray<FTransform> m_RoomTransforms;
+    DungeonCore::LayoutCache m_LayoutCache;
+
+    DungeonCore::GenerationStats m_GenerationStats;
+    FDungeonStatsSink m_StatsSink;
+
+    //GenerateFromSeed runs the same generator as the async generation and the headless tools, to the end in one call
+    TUniquePtr<DungeonCore::Generator> m_pGenerator;
+    uint64 m_ParamsKey = 0;
+
+    //the async generation runs on its own grid and graph, the ones on screen are only touched by the commit
+    TUniquePtr<DungeonCore::Generator> m_pAsyncGenerator;
+    FDungeonStatsSink m_AsyncStatsSink; //its stages run on another thread than the synchronous ones
+    uint64 m_AsyncParamsKey = 0;
+    TFuture<void> m_AsyncSlice;
+    FThreadSafeBool m_bCancelAsync;
+    bool m_bAsyncRunning = false;
+    bool m_bAsyncReady = false;
+    bool m_bCommitWhenDone = true;
 };
@@ -9,12 +9,14 @@
 #include "Engine.h"
 
 
-#include "C_Grid.h"
+#include "DungeonCore/Graph.h"
 
 
 #include "C_Graph.generated.h"
 
 
+//Holds the triangulation, MST and loop edges of the dungeon on screen for the debug drawing.
+//They are built by DungeonCore::Generator, see AC_Generate::GenerateFromSeed, this component only draws them
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class DUNGEONGENERATION_API UC_Graph : public UActorComponent
 {
@@ -35,33 +37,17 @@ public:
 
 public:
 
-	TArray<FVector> m_Locations;
-
-	void SetPointsArray(TArray<FVector>& points);
-	void AddPoint(FVector& point);
-	void CreateSuperTriangle(int32 increment, int32 numRooms, int32 margin);
+	//nothing to draw
 	void DeletePoints();
+	int32 GetNumPoints() const;
 
-	void TriangulationAlgorithm();
-
-	void Path();
-
-
-
+	//takes over the graph of a generation, so the debug drawing shows it
+	void SetCoreGraph(const DungeonCore::Graph& graph) { m_Graph = graph; }
 
 private:
 
-
-	FTriangle m_SuperTriangle;
-	TArray<FTriangle> m_TriangulationTrianglesArray;
-	TArray<FTriangulationEdge> m_TriangulationEdgesArray;
-	TArray<FTriangulationEdge> m_MSTEdgesArray;;
-
-	TArray<FTriangulationNode> m_NodesArray;
-
-	void GetEdges();
-	void CreateNodes();
-	void FindMinimumSpanningTree(TArray<FTriangulationEdge>& edges);
+	//debug drawing reads the flat arrays of the engine-free graph directly
+	DungeonCore::Graph m_Graph;
 
 public:
 
@@ -69,12 +55,4 @@ public:
 	void DrawDebugMTS() const;
 	void DrawDebugTriangulation() const;
 
-private:
-
-	//HELPERS
-	bool isPointInsideCircumcircle(const FVector& p, const FTriangle& t) const;
-	bool sharesEdge(const FTriangle& t, const FEdge& e) const;
-	bool hasCommonVertex(const FTriangle& t1, const FTriangle& t2) const;
-	void Union(FTriangulationNode* rootA, FTriangulationNode* rootB);
-	FTriangulationNode* FindRoot(FTriangulationNode* node);
 };
@@ -6,180 +6,92 @@
 #include "GameFramework/Actor.h"
 #include "C_Block.h"
 #include "DrawDebugHelpers.h"
+#include "DataTypes.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "DungeonCore/Grid.h"
 
 
 #include "C_Grid.generated.h"
-enum class FCellType
-{
-	Room,
-	Corridor,
-	Empty
-};
 
-USTRUCT(BlueprintType)
-struct FGridConnection
+//how the corridors are searched, mirrors DungeonCore::PathSearch
+UENUM(BlueprintType)
+enum class ECorridorSearch : uint8
 {
-	GENERATED_BODY()
-		FGridConnection() {};
-	FGridConnection(int32 from, int32 to, float cost = 1.f)
-		: m_From(from),
-		m_To(to),
-		m_Cost(cost)
-	{
-	};
-
-	int GetFrom() const { return m_From; }
-	void SetFrom(int newFrom) { m_From = newFrom; }
-
-	int GetTo() const { return m_To; }
-	void SetTo(int newTo) { m_To = newTo; }
-
-	float GetCost() const { return m_Cost; }
-	void SetCost(float newCost) { m_Cost = newCost; }
-
-	bool IsValid() const { return (m_From != -1 && m_To != -1); }
-
-	bool operator==(const FGridConnection& rhs) const
-	{
-		return rhs.m_From == this->m_From &&
-			rhs.m_To == this->m_To &&
-			rhs.m_Cost == this->m_Cost;
-	}
-
-	bool operator!=(const FGridConnection& rhs) const
-	{
-		return !(*this == rhs);
-	}
-
-	int m_From;
-	int m_To;
-
-	// the cost of traversing the edge
-	float m_Cost;
+	AStar UMETA(DisplayName = "A*"),
+	JumpPoint UMETA(DisplayName = "Jump point search"),
+	Hierarchical UMETA(DisplayName = "Hierarchical (HPA*)"),
+	Bidirectional UMETA(DisplayName = "Bidirectional A*")
 };
 
-
-//Struct used for Astart Algorithm
-USTRUCT(BlueprintType)
-struct FNodeRecord
+UCLASS()
+class DUNGEONGENERATION_API AC_Grid : public AActor
 {
 	GENERATED_BODY()
 
-	FCell* pNode = nullptr;
-	FGridConnection pConnection;
-	float costSoFar = 0.f; // accumulated g-costs of all the connections leading up to this one
-	float estimatedTotalCost = 0.f; // f-cost (= costSoFar + h-cost)
-
-	bool operator==(const FNodeRecord& other) const
-	{
-		return pNode == other.pNode
-			&& pConnection == other.pConnection
-			&& costSoFar == other.costSoFar
-			&& estimatedTotalCost == other.estimatedTotalCost;
-	};
-
-	bool operator<(const FNodeRecord& other) const
-	{
-		return estimatedTotalCost < other.estimatedTotalCost;
-	};
-};
+public:
+	// Sets default values for this actor's properties
+	AC_Grid();
 
-USTRUCT(BlueprintType)
-struct FCell
-{
-	GENERATED_BODY()
+	//grid size, rebuilt when changed. the cells are a few bits each, so thousands per side are fine
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = "2", ClampMax = "8192"))
+	int32 m_NrRow = 100;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = "2", ClampMax = "8192"))
+	int32 m_NrColumns = 100;
 
-	FCell() {};
-	FCell(FVector bottomLeft, float width, float depth, AC_Grid* grid,FCellType type = FCellType::Empty)
-		: pStaticBox(nullptr),
-		_bottomLeft(bottomLeft),
-		_width(width),
-		_depth(depth),
-		_type(FCellType::Empty),
-		_isEmpty(true),
-		_isCorridor(false)
-	{
-		_center = FVector(_bottomLeft.X + (_width / 2.0f), _bottomLeft.Y + (_depth / 2.0f), 0);
-	}
-
-	UStaticMeshComponent* pStaticBox;
-	//list of connections. minimum of 2, maximum of 4
-	TArray<FGridConnection> _connections;
-
-	//hides the sattic meshes
-	void SetVisibillity(bool isHidden)
-	{
-		pStaticBox->bHiddenInGame = isHidden;
-		pStaticBox->MarkRenderStateDirty();
-	}
-
-	bool isEmpty()
-	{
-		//if (_type == FCellType::Empty)
-		//	return true;
-		//return false;
-		return _isEmpty;
-	}
-
-	void SetFull()
-	{
-		_type = FCellType::Room;
-		_isEmpty = false;
-	}
-
-	FVector _bottomLeft;
-	FVector _center;
-	float _width;
-	float _depth;
-	FCellType _type;
-	float _cost;
-	bool _isEmpty = true;
-	int32 _index;
-	bool _isCorridor = false;
-
-	bool operator==(const FCell& Other) const
-	{
-		if (_bottomLeft == Other._bottomLeft)
-			return true;
-
-		return false;
-	}
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = "1.0"))
+	float m_Width = 100;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Grid", meta = (ClampMin = "1.0"))
+	float m_Depth = 100;
 
-};
+	//cost of stepping onto an existing corridor, below 1 makes later corridors merge into earlier ones
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Corridors", meta = (ClampMin = "0.1", ClampMax = "1"))
+	float m_CorridorCostScale = 1.f;
 
+	//searches the corridors on the task graph. same result as the serial search, only used when m_CorridorCostScale is 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Corridors")
+	bool m_bParallelCorridors = true;
 
+	//jump point search finds corridors as short as A* with far fewer expansions, HPA* slightly longer ones on a graph over 16x16 clusters,
+	//built once per grid. bidirectional A* searches from both rooms, as short as A*. A* still runs while m_CorridorCostScale is below 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Corridors")
+	ECorridorSearch m_CorridorSearch = ECorridorSearch::AStar;
 
-UCLASS()
-class DUNGEONGENERATION_API AC_Grid : public AActor
-{
-	GENERATED_BODY()
-	
-public:	
-	// Sets default values for this actor's properties
-	AC_Grid();
+	//the values line up with DungeonCore::PathSearch
+	DungeonCore::PathSearch GetCorePathSearch() const { return static_cast<DungeonCore::PathSearch>(m_CorridorSearch); }
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	//resizes the core grid to the properties, when they differ
+	virtual void OnConstruction(const FTransform& Transform) override;
 
-public:	
+public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 	//Returns the index of a cell given its position
 	int32 GetCellIndex(const FVector& pos) const;
-	//Returns the Cell given an index
-	FCell* GetCellAtIndex(int32 index);
+	//Returns a copy of the Cell given an index, geometry included
+	DungeonCore::Cell GetCellAtIndex(int32 index) const;
 	//return the array size
-	int32 GetArraySize();
+	int32 GetArraySize() const;
+
+	//the engine-free grid the generation runs on
+	DungeonCore::Grid& GetCoreGrid() { return m_Grid; }
 
-	//"Empties the cells" turns the static meshes invisible
+	//"Empties the cells" removes every cell instance
 	void EmptyCells();
 
-	void AStartPath(const FVector& startPos, const FVector& endPos);
-	float GetHeuristicCost(const FCell* pStartNode, const FCell* pEndNode) const;
+	//the task graph when m_bParallelCorridors is set, for the generator to spread the corridor searches over. nullptr runs them serially
+	DungeonCore::ParallelExecutor* GetCorridorExecutor() { return m_bParallelCorridors ? &m_Executor : nullptr; }
+
+	//adds an instance for every cell the core grid already has marked as corridor, for layouts loaded instead of routed
+	void ShowCorridors();
+	//swaps in the rooms and corridors of a grid generated elsewhere and shows its corridors.
+	//false, with nothing changed, if that grid doesn't have the same rows and columns
+	bool ShowGeneratedCells(const DungeonCore::Grid& source);
 
 
 	//Debug Drawing Functions
@@ -188,25 +100,15 @@ public:
 
 private:
 
-	int32 m_NrRow = 100;
-	int32 m_NrColumns = 100;
-
-	float m_Width = 100;
-	float m_Depth = 100;
-	TArray<FCell> m_CellsArray;
-	TArray<FVector> m_Directions;
+	DungeonCore::Grid m_Grid;
+	FTaskGraphExecutor m_Executor;
 
+	//every visible cell is one instance of this mesh, added in bulk once the corridors are known
+	UPROPERTY(VisibleAnywhere, Category = "Cells")
+	UInstancedStaticMeshComponent* m_pCellInstances = nullptr;
+	TArray<FTransform> m_InstanceTransforms;
 
-	//creates each individual cell
+	//creates the instanced mesh the cells are drawn with
 	void CreateCells();
-	//creates connections for each individual cell
-	void CreateConnections();
-
-
-	//finds the index of the row given yPos
-	int32 GetRowIndex(const float yPosition) const;
-	//finds the index of the column given xPos
-	int32 GetColumnIndex(const float xPosition) const;
-
-
+	FTransform GetCellTransform(int32 index) const;
 };
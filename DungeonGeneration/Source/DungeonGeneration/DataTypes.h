@@ -10,191 +10,51 @@
 #include <cmath>
 #include "Math/Vector.h"
 #include "DrawDebugHelpers.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "DungeonCore/DungeonTypes.h"
+#include "DungeonCore/Graph.h"
+#include "DungeonCore/Parallel.h"
 
-#include "DataTypes.generated.h"
 
-
-
-// Upgraded Edge struct
-struct FTriangulationEdge : public FEdge
+//conversions between the engine types and the engine-free DungeonCore ones
+inline DungeonCore::Vec2 ToCoreVector(const FVector& vector)
 {
-    float _cost; //leght of the FTriangulationEdge
-
-    FTriangulationNode* _startNode; // Pointer to the start node
-    FTriangulationNode* _endNode;   // Pointer to the end node
-
-    FTriangulationEdge() {};
-
-    FTriangulationEdge(FVector V1, FVector V2) //constructor given two points
-        :FEdge(V1, V2)
-    {
-        _cost = CalculateCost(Vertex[0], Vertex[1]);
-    }
-
-    FTriangulationEdge(FVector V1, FVector V2, FTriangulationNode* StartNode, FTriangulationNode* EndNode) //contructor with two center points and nodes
-        : FEdge(V1, V2), _startNode(StartNode), _endNode(EndNode)
-    {
-        _cost = CalculateCost(Vertex[0], Vertex[1]);
-    }
-
-    float CalculateCost(const FVector V1, const FVector V2)
-    {
-        return FVector::Distance(V1, V2);
-    }
-};
+    return DungeonCore::Vec2(vector.X, vector.Y);
+}
 
-/// <summary>
-/// TRIANGLE STRUCT
-/// </summary>
-USTRUCT(BlueprintType)
-struct FTriangle
+inline FVector ToFVector(const DungeonCore::Vec2& vector, float z = 0.f)
 {
-    GENERATED_BODY()
-
-    TArray<FTriangulationEdge> _edgesArray; //edges of Triangle
-    TArray<FVector> _vertices; //each point of triangle (center point of a particular cell)
-
-    float _circumRadius; //the radius of a circumpherence that emcompases the three points of the triangle
-    FVector _circumCenter; //the center of said circumference
+    return FVector(vector.X, vector.Y, z);
+}
 
-    FTriangle() {};
-
-    FTriangle(FVector V1, FVector V2, FVector V3) //triangle constructor
-    {
-        _vertices.Add(V1); //first point will be added
-
-        bool isCounterClockwise = IsCounterClockwise(V1, V2, V3); //figure if triangle is being added clock or counter clockwise
-        //set in the respective order
-        FVector vector2 = isCounterClockwise ? V2 : V3;
-        FVector vector3 = isCounterClockwise ? V3 : V2;
-        // add to vertices in the respective order
-        _vertices.Add(vector2); 
-        _vertices.Add(vector3);
-
-        //given the vertices, create the edges between each triangle
-        _edgesArray.Add(FTriangulationEdge(_vertices[0], _vertices[1]));
-        _edgesArray.Add(FTriangulationEdge(_vertices[1], _vertices[2]));
-        _edgesArray.Add(FTriangulationEdge(_vertices[2], _vertices[0]));
-
-        //calculations
-        _circumCenter = CalculateCircumCenter();
-        _circumRadius = CalculateRadius();
-    }
-
-    //calculations
-    bool IsCounterClockwise(const FVector& pointA, const FVector& pointB, const FVector& pointC)
-    {
-        float result = (pointB.X - pointA.X) * (pointC.Y - pointA.Y) - (pointC.X - pointA.X) * (pointB.Y - pointA.Y);
-        return result > 0;
-    }
-
-    //calculate circumcenter
-    FVector CalculateCircumCenter()
-    {
-        FVector pA = _vertices[0];
-        FVector pB = _vertices[1];
-        FVector pC = _vertices[2];
-
-        // Calculate intermediate values
-        float Dx = (pA.X * pA.X + pA.Y * pA.Y) * (pB.Y - pC.Y) + (pB.X * pB.X + pB.Y * pB.Y) * (pC.Y - pA.Y) + (pC.X * pC.X + pC.Y * pC.Y) * (pA.Y - pB.Y);
-        float Dy = (pA.X * pA.X + pA.Y * pA.Y) * (pC.X - pB.X) + (pB.X * pB.X + pB.Y * pB.Y) * (pA.X - pC.X) + (pC.X * pC.X + pC.Y * pC.Y) * (pB.X - pA.X);
-        float D = 2 * ((pA.X - pB.X) * (pB.Y - pC.Y) - (pB.X - pC.X) * (pA.Y - pB.Y));
-
-        // Calculate circumcenter coordinates
-        float x = Dx / D;
-        float y = Dy / D;
-
-        return FVector(x, y, 0);
-    }
+//The graph types are the flat ones from the core: vertices are indices into one shared point buffer,
+//triangles keep their circumcircle as a center plus squared radius and nothing allocates per triangle.
+using FTriangulationEdge = DungeonCore::TriangulationEdge;
+using FTriangle = DungeonCore::Triangle;
 
-    //calculate radius
-    float CalculateRadius()
+//runs the core's parallel work on the task graph
+class FTaskGraphExecutor final : public DungeonCore::ParallelExecutor
+{
+public:
+    int32_t GetNumWorkers() const override
     {
-        return FVector::Distance(_vertices[0], _circumCenter);
+        return FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
     }
 
-    //bool ContainsEdge(const FTriangulationEdge& edge)
-    //{
-    //    for (const FVector& vertex : _vertices)
-    //    {
-    //        if (vertex == edge.Vertex[0] || vertex == edge.Vertex[1])
-    //        {
-    //            return true;
-    //        }
-    //    }
-    //    return false;
-    //}
-
-    bool operator==(const FTriangle& Other) const
+    void For(int32_t count, const std::function<void(int32_t index, int32_t worker)>& body) override
     {
-        // Check if both triangles have the same number of vertices
-        if (_vertices.Num() != Other._vertices.Num())
-            return false;
-
-        // Check if all vertices of the triangles match
-        int numOfEqualVertices{ 0 };
-        for (int32 i = 0; i < _vertices.Num(); ++i)
+        //ParallelFor doesn't tell which thread runs an index, so every worker slot gets one contiguous chunk
+        const int32 numChunks = FMath::Min(GetNumWorkers(), count);
+        ParallelFor(numChunks, [&body, count, numChunks](int32 chunk)
         {
-            for (int32 j = 0; j < Other._vertices.Num(); ++j)
+            const int32 first = static_cast<int32>(static_cast<int64>(count) * chunk / numChunks);
+            const int32 last = static_cast<int32>(static_cast<int64>(count) * (chunk + 1) / numChunks);
+            for (int32 index = first; index < last; ++index)
             {
-                if (_vertices[i] != Other._vertices[j])
-                    ++numOfEqualVertices;
+                body(index, chunk);
             }
-        }
-        if (numOfEqualVertices == 3)
-        {
-            return true;
-        }
-
-        // Check if both triangles have the same circumCenter and circumRadius
-        if (_circumCenter != Other._circumCenter || _circumRadius != Other._circumRadius)
-            return false;
-
-        // If all checks pass, the triangles are equal
-        return true;
-    }
-
-};
-
-
-
-USTRUCT(BlueprintType)
-struct FTriangulationNode
-{
-    GENERATED_BODY()
-
-    FVector _location;
-    TArray<FTriangulationEdge> _connections; //list of connections to other FTriangulationNodes
-
-    FTriangulationNode* _parent; // Parent node in the Union-Find data structure
-    int32 _rank;            // Rank for Union-Find optimization
-
-    FTriangulationNode()
-        : _parent(this), _rank(0)
-    {
-    }
-
-    void AddConnection(FTriangulationEdge& edge)
-    {
-        _connections.AddUnique(edge);
-    }
-
-    void AddConnection(const TArray<FTriangulationEdge>& edges)
-    {
-        for(const FTriangulationEdge& edge : edges)
-        {
-            _connections.AddUnique(edge);
-        }
-    }
-
-    void AddLocation(FVector location)
-    {
-        _location = location;
-    }
-
-    bool operator==(const FTriangulationNode& Other) const
-    {
-        return (Other._location == _location);
+        });
     }
 };
 
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BatchGenerator.h"
+
+#include <algorithm>
+
+namespace DungeonCore
+{
+	BatchGenerator::BatchGenerator(const GenerationParams& params, ParallelExecutor* pExecutor, int32_t seedsPerChunk)
+		: m_Params(params),
+		m_pExecutor(pExecutor)
+	{
+		const int32_t numWorkers = pExecutor != nullptr ? pExecutor->GetNumWorkers() : 1;
+		m_SeedsPerChunk = seedsPerChunk > 0 ? seedsPerChunk : numWorkers * 16;
+
+		//the generators run inside the executor, their corridors are routed serially
+		for (int32_t worker{ 0 }; worker < numWorkers; ++worker)
+		{
+			m_Generators.push_back(std::unique_ptr<Generator>(new Generator(params)));
+		}
+		m_ChunkBytes.resize(m_SeedsPerChunk);
+		m_ChunkCrowded.resize(m_SeedsPerChunk);
+	}
+
+	bool BatchGenerator::Run(uint64_t firstSeed, uint64_t count, LayoutArchiveWriter& writer, BatchResult& outResult)
+	{
+		outResult = BatchResult();
+
+		for (uint64_t chunkStart{ 0 }; chunkStart < count; chunkStart += m_SeedsPerChunk)
+		{
+			const int32_t chunkSize = static_cast<int32_t>(std::min<uint64_t>(m_SeedsPerChunk, count - chunkStart));
+
+			const auto generate = [this, firstSeed, chunkStart](int32_t index, int32_t worker)
+			{
+				Generator& generator = *m_Generators[worker];
+				const DungeonLayout& layout = generator.Generate(firstSeed + chunkStart + index);
+
+				m_ChunkBytes[index].clear();
+				WriteLayout(m_Params, layout.seed, layout.rooms, layout.allRoomsPlaced, generator.GetGraph(), generator.GetGrid(), m_ChunkBytes[index]);
+				m_ChunkCrowded[index] = layout.allRoomsPlaced ? 0 : 1;
+			};
+
+			if (m_pExecutor != nullptr)
+			{
+				m_pExecutor->For(chunkSize, generate);
+			}
+			else
+			{
+				for (int32_t index{ 0 }; index < chunkSize; ++index)
+				{
+					generate(index, 0);
+				}
+			}
+
+			//in seed order, whichever worker finished first
+			for (int32_t index{ 0 }; index < chunkSize; ++index)
+			{
+				if (!writer.Append(firstSeed + chunkStart + index, m_ChunkBytes[index]))
+					return false;
+
+				++outResult.numLayouts;
+				outResult.numCrowded += m_ChunkCrowded[index];
+				outResult.numBytes += m_ChunkBytes[index].size();
+			}
+
+			if (!writer.Flush())
+				return false;
+		}
+		return true;
+	}
+}
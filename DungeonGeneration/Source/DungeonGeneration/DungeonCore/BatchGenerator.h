@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "Generator.h"
+#include "LayoutArchive.h"
+#include "Parallel.h"
+
+#include <memory>
+
+namespace DungeonCore
+{
+	//totals of one BatchGenerator::Run
+	struct BatchResult
+	{
+		uint64_t numLayouts = 0;
+		uint64_t numCrowded = 0; //layouts that ran out of placement attempts
+		uint64_t numBytes = 0;
+	};
+
+	//Generates a range of seeds with one Generator per worker and streams them into an archive.
+	//Seeds are done a chunk at a time and appended in seed order, so memory stays at one chunk
+	//and the archive is the same whatever the number of workers.
+	class BatchGenerator
+	{
+	public:
+		//seedsPerChunk 0 picks a few per worker
+		BatchGenerator(const GenerationParams& params, ParallelExecutor* pExecutor = nullptr, int32_t seedsPerChunk = 0);
+
+		//generates seeds firstSeed to firstSeed + count - 1 and appends them to the writer. false if a write failed
+		bool Run(uint64_t firstSeed, uint64_t count, LayoutArchiveWriter& writer, BatchResult& outResult);
+
+	private:
+		GenerationParams m_Params;
+		ParallelExecutor* m_pExecutor = nullptr;
+		int32_t m_SeedsPerChunk = 1;
+
+		std::vector<std::unique_ptr<Generator>> m_Generators; //one per worker, each keeps its own grid and graph
+		std::vector<std::vector<uint8_t>> m_ChunkBytes;      //serialized layouts of the current chunk, by seed
+		std::vector<uint8_t> m_ChunkCrowded;
+	};
+}
@@ -0,0 +1,564 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Delaunay.h"
+
+#include <algorithm>
+
+namespace DungeonCore
+{
+	namespace
+	{
+		//> 0 if c is left of a->b. exact for integer coordinates below 2^26, which covers cell centers
+		double Orient(const Vec2& a, const Vec2& b, const Vec2& c)
+		{
+			return (static_cast<double>(b.X) - a.X) * (static_cast<double>(c.Y) - a.Y)
+				- (static_cast<double>(b.Y) - a.Y) * (static_cast<double>(c.X) - a.X);
+		}
+
+		//> 0 if d is inside the circumcircle of the counter clockwise triangle abc
+		double InCircle(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+		{
+			const double adx = static_cast<double>(a.X) - d.X, ady = static_cast<double>(a.Y) - d.Y;
+			const double bdx = static_cast<double>(b.X) - d.X, bdy = static_cast<double>(b.Y) - d.Y;
+			const double cdx = static_cast<double>(c.X) - d.X, cdy = static_cast<double>(c.Y) - d.Y;
+
+			const double aLift = adx * adx + ady * ady;
+			const double bLift = bdx * bdx + bdy * bdy;
+			const double cLift = cdx * cdx + cdy * cdy;
+
+			return aLift * (bdx * cdy - cdx * bdy)
+				+ bLift * (cdx * ady - adx * cdy)
+				+ cLift * (adx * bdy - bdx * ady);
+		}
+
+		//position of (x, y) along a 2^16 x 2^16 Hilbert curve
+		uint64_t HilbertIndex(uint32_t x, uint32_t y)
+		{
+			const uint32_t n = 1u << 16;
+			uint64_t d = 0;
+			for (uint32_t s = n / 2; s > 0; s /= 2)
+			{
+				const uint32_t rx = (x & s) > 0;
+				const uint32_t ry = (y & s) > 0;
+				d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+				//rotate the quadrant
+				if (ry == 0)
+				{
+					if (rx == 1)
+					{
+						x = n - 1 - x;
+						y = n - 1 - y;
+					}
+					std::swap(x, y);
+				}
+			}
+			return d;
+		}
+	}
+
+	void DelaunayMesh::Triangulate(const std::vector<Vec2>& points)
+	{
+		m_pPoints = &points;
+		m_Triangles.clear();
+		m_FreeTriangles.clear();
+		m_CollinearChain.clear();
+		m_NumRealTriangles = 0;
+
+		//one slot per point plus one for the ghost vertex
+		m_FanFrom.assign(points.size() + 1, -1);
+
+		SortInsertOrder();
+
+		if (!CreateFirstTriangle())
+		{
+			//no three points span a triangle, chain them along their line instead
+			std::vector<int32_t> sorted(m_InsertOrder);
+			std::sort(sorted.begin(), sorted.end(), [&points](int32_t a, int32_t b)
+				{
+					if (points[a].X != points[b].X)
+						return points[a].X < points[b].X;
+					if (points[a].Y != points[b].Y)
+						return points[a].Y < points[b].Y;
+					return a < b;
+				});
+			for (int32_t index : sorted)
+			{
+				if (m_CollinearChain.empty() || points[m_CollinearChain.back()] != points[index])
+					m_CollinearChain.push_back(index);
+			}
+			return;
+		}
+
+		int32_t hint = 0;
+		for (int32_t pointIndex : m_InsertOrder)
+		{
+			if (pointIndex >= 0)
+				InsertPoint(pointIndex, hint);
+		}
+
+		for (const MeshTriangle& triangle : m_Triangles)
+		{
+			if (IsReal(triangle))
+				++m_NumRealTriangles;
+		}
+	}
+
+	void DelaunayMesh::SortInsertOrder()
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+		const int32_t numPoints = static_cast<int32_t>(points.size());
+
+		m_InsertOrder.resize(numPoints);
+		if (numPoints == 0)
+			return;
+
+		float minX = points[0].X, maxX = points[0].X;
+		float minY = points[0].Y, maxY = points[0].Y;
+		for (const Vec2& point : points)
+		{
+			minX = std::min(minX, point.X);
+			maxX = std::max(maxX, point.X);
+			minY = std::min(minY, point.Y);
+			maxY = std::max(maxY, point.Y);
+		}
+
+		const double extent = std::max(static_cast<double>(maxX) - minX, static_cast<double>(maxY) - minY);
+		const double scale = extent > 0.0 ? 65535.0 / extent : 0.0;
+
+		std::vector<std::pair<uint64_t, int32_t>> keys(numPoints);
+		for (int32_t i{ 0 }; i < numPoints; ++i)
+		{
+			const uint32_t x = static_cast<uint32_t>((points[i].X - minX) * scale);
+			const uint32_t y = static_cast<uint32_t>((points[i].Y - minY) * scale);
+			keys[i] = { HilbertIndex(x, y), i };
+		}
+
+		//ties resolved by index so the order never depends on the sort implementation
+		std::sort(keys.begin(), keys.end());
+		for (int32_t i{ 0 }; i < numPoints; ++i)
+		{
+			m_InsertOrder[i] = keys[i].second;
+		}
+	}
+
+	bool DelaunayMesh::CreateFirstTriangle()
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+		if (m_InsertOrder.size() < 3)
+			return false;
+
+		//first point, first point different from it, first point not on their line
+		size_t first = 0;
+		size_t second = 1;
+		while (second < m_InsertOrder.size() && points[m_InsertOrder[second]] == points[m_InsertOrder[first]])
+			++second;
+		if (second >= m_InsertOrder.size())
+			return false;
+
+		size_t third = second + 1;
+		while (third < m_InsertOrder.size() && Orient(points[m_InsertOrder[first]], points[m_InsertOrder[second]], points[m_InsertOrder[third]]) == 0.0)
+			++third;
+		if (third >= m_InsertOrder.size())
+			return false;
+
+		int32_t a = m_InsertOrder[first];
+		int32_t b = m_InsertOrder[second];
+		int32_t c = m_InsertOrder[third];
+		if (Orient(points[a], points[b], points[c]) < 0.0)
+			std::swap(b, c);
+
+		//these three are in the mesh now, skip them during insertion
+		m_InsertOrder[first] = -1;
+		m_InsertOrder[second] = -1;
+		m_InsertOrder[third] = -1;
+
+		//the real triangle and one ghost triangle behind each of its edges
+		const int32_t g = GhostVertex;
+		m_Triangles.push_back({ { a, b, c }, { -1, -1, -1 } });
+		m_Triangles.push_back({ { c, b, g }, { -1, -1, -1 } });
+		m_Triangles.push_back({ { a, c, g }, { -1, -1, -1 } });
+		m_Triangles.push_back({ { b, a, g }, { -1, -1, -1 } });
+		m_Marks.resize(std::max(m_Marks.size(), m_Triangles.size()), 0);
+
+		//link them by matching opposite edges
+		for (size_t t{ 0 }; t < m_Triangles.size(); ++t)
+		{
+			for (int32_t i{ 0 }; i < 3; ++i)
+			{
+				const int32_t from = m_Triangles[t].v[(i + 1) % 3];
+				const int32_t to = m_Triangles[t].v[(i + 2) % 3];
+				for (size_t other{ 0 }; other < m_Triangles.size(); ++other)
+				{
+					for (int32_t j{ 0 }; j < 3 && other != t; ++j)
+					{
+						if (m_Triangles[other].v[(j + 1) % 3] == to && m_Triangles[other].v[(j + 2) % 3] == from)
+							m_Triangles[t].n[i] = static_cast<int32_t>(other);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void DelaunayMesh::InsertPoint(int32_t pointIndex, int32_t& hint)
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+		const Vec2& p = points[pointIndex];
+
+		int32_t start = Locate(p, hint);
+		if (start < 0)
+			start = LocateBruteForce(p);
+		if (start < 0)
+			return;
+
+		//a point on top of an existing vertex adds nothing
+		for (int32_t vertex : m_Triangles[start].v)
+		{
+			if (vertex >= 0 && points[vertex] == p)
+				return;
+		}
+
+		if (!GrowCavity(pointIndex, start))
+			return;
+
+		//the cavity slots are recycled for the new fan, which always has two more triangles
+		for (int32_t cavityTriangle : m_Cavity)
+		{
+			m_Triangles[cavityTriangle].v[0] = DeadVertex;
+			m_FreeTriangles.push_back(cavityTriangle);
+		}
+
+		m_NewTriangles.clear();
+		for (const BoundaryEdge& edge : m_Boundary)
+		{
+			const int32_t triangle = AllocateTriangle();
+			m_Triangles[triangle] = { { edge.from, edge.to, pointIndex }, { -1, -1, edge.outer } };
+			LinkOuter(edge.outer, edge.from, edge.to, triangle);
+
+			m_FanFrom[edge.from + 1] = triangle;
+			m_NewTriangles.push_back(triangle);
+		}
+
+		//stitch the fan: the edge to->p is shared with the triangle starting at to, p->from with the one ending at from
+		for (size_t k{ 0 }; k < m_Boundary.size(); ++k)
+		{
+			MeshTriangle& triangle = m_Triangles[m_NewTriangles[k]];
+			const int32_t next = m_FanFrom[m_Boundary[k].to + 1];
+			triangle.n[0] = next;
+			m_Triangles[next].n[1] = m_NewTriangles[k];
+		}
+
+		for (size_t k{ 0 }; k < m_Boundary.size(); ++k)
+		{
+			m_FanFrom[m_Boundary[k].from + 1] = -1;
+			if (IsReal(m_Triangles[m_NewTriangles[k]]))
+				hint = m_NewTriangles[k];
+		}
+	}
+
+	int32_t DelaunayMesh::Locate(const Vec2& p, int32_t hint) const
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+
+		int32_t triangle = hint;
+		const int32_t ghostCorner = FindGhostCorner(m_Triangles[triangle]);
+		if (ghostCorner >= 0)
+			triangle = m_Triangles[triangle].n[ghostCorner];
+
+		//visibility walk, the starting edge rotates every step so degenerate meshes cannot trap it in a cycle
+		const size_t maxSteps = m_Triangles.size() + 16;
+		for (size_t step{ 0 }; step < maxSteps; ++step)
+		{
+			const MeshTriangle& current = m_Triangles[triangle];
+
+			//walked across the hull, p is outside of it
+			if (FindGhostCorner(current) >= 0)
+				return triangle;
+
+			bool bMoved = false;
+			for (size_t k{ 0 }; k < 3 && !bMoved; ++k)
+			{
+				const size_t i = (k + step) % 3;
+				const Vec2& from = points[current.v[(i + 1) % 3]];
+				const Vec2& to = points[current.v[(i + 2) % 3]];
+				if (Orient(from, to, p) < 0.0)
+				{
+					triangle = current.n[i];
+					bMoved = true;
+				}
+			}
+
+			if (!bMoved)
+				return triangle;
+		}
+		return -1;
+	}
+
+	int32_t DelaunayMesh::LocateBruteForce(const Vec2& p) const
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+
+		for (size_t t{ 0 }; t < m_Triangles.size(); ++t)
+		{
+			const MeshTriangle& triangle = m_Triangles[t];
+			if (IsReal(triangle)
+				&& Orient(points[triangle.v[0]], points[triangle.v[1]], p) >= 0.0
+				&& Orient(points[triangle.v[1]], points[triangle.v[2]], p) >= 0.0
+				&& Orient(points[triangle.v[2]], points[triangle.v[0]], p) >= 0.0)
+				return static_cast<int32_t>(t);
+		}
+
+		for (size_t t{ 0 }; t < m_Triangles.size(); ++t)
+		{
+			if (m_Triangles[t].v[0] != DeadVertex && !IsReal(m_Triangles[t]) && InConflict(static_cast<int32_t>(t), p))
+				return static_cast<int32_t>(t);
+		}
+		return -1;
+	}
+
+	bool DelaunayMesh::InConflict(int32_t triangle, const Vec2& p) const
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+		const MeshTriangle& current = m_Triangles[triangle];
+
+		const int32_t ghostCorner = FindGhostCorner(current);
+		if (ghostCorner < 0)
+			return InCircle(points[current.v[0]], points[current.v[1]], points[current.v[2]], p) > 0.0;
+
+		//a ghost triangle conflicts when p is outside its hull edge, or on the edge itself
+		const Vec2& a = points[current.v[(ghostCorner + 1) % 3]];
+		const Vec2& b = points[current.v[(ghostCorner + 2) % 3]];
+		const double orientation = Orient(a, b, p);
+		if (orientation != 0.0)
+			return orientation > 0.0;
+
+		const double dot = (static_cast<double>(p.X) - a.X) * (static_cast<double>(b.X) - a.X) + (static_cast<double>(p.Y) - a.Y) * (static_cast<double>(b.Y) - a.Y);
+		const double lengthSquared = (static_cast<double>(b.X) - a.X) * (static_cast<double>(b.X) - a.X) + (static_cast<double>(b.Y) - a.Y) * (static_cast<double>(b.Y) - a.Y);
+		return dot > 0.0 && dot < lengthSquared;
+	}
+
+	bool DelaunayMesh::GrowCavity(int32_t pointIndex, int32_t start)
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+		const Vec2& p = points[pointIndex];
+
+		//marks: m_Stamp = in the cavity, +1 = rejected, +2 = pending while pruning
+		if (m_Stamp > 0xFFFFFFF0u)
+		{
+			std::fill(m_Marks.begin(), m_Marks.end(), 0);
+			m_Stamp = 0;
+		}
+		m_Stamp += 4;
+
+		m_Cavity.clear();
+		m_Cavity.push_back(start);
+		m_Marks[start] = m_Stamp;
+
+		//p on an edge of the starting triangle: the triangle behind it has to go as well
+		const MeshTriangle& startTriangle = m_Triangles[start];
+		if (IsReal(startTriangle))
+		{
+			for (int32_t i{ 0 }; i < 3; ++i)
+			{
+				const int32_t neighbor = startTriangle.n[i];
+				if (m_Marks[neighbor] != m_Stamp && Orient(points[startTriangle.v[(i + 1) % 3]], points[startTriangle.v[(i + 2) % 3]], p) == 0.0)
+				{
+					m_Marks[neighbor] = m_Stamp;
+					m_Cavity.push_back(neighbor);
+				}
+			}
+		}
+		const size_t numRoots = m_Cavity.size();
+
+		//BFS over the neighbors that have p inside their circumcircle
+		m_Stack.assign(m_Cavity.begin(), m_Cavity.end());
+		while (!m_Stack.empty())
+		{
+			const int32_t current = m_Stack.back();
+			m_Stack.pop_back();
+
+			for (int32_t neighbor : m_Triangles[current].n)
+			{
+				if (m_Marks[neighbor] == m_Stamp || m_Marks[neighbor] == m_Stamp + 1)
+					continue;
+
+				if (InConflict(neighbor, p))
+				{
+					m_Marks[neighbor] = m_Stamp;
+					m_Cavity.push_back(neighbor);
+					m_Stack.push_back(neighbor);
+				}
+				else
+				{
+					m_Marks[neighbor] = m_Stamp + 1;
+				}
+			}
+		}
+
+		//rounding on near co-circular points can produce a cavity p does not see completely.
+		//drop the triangles behind the edges p does not see until the cavity is star shaped again
+		const int32_t roots = static_cast<int32_t>(numRoots);
+		bool bRootHidden = false;
+		while (CollectBoundary(p, roots, bRootHidden) > 0)
+		{
+			KeepConnected(roots);
+		}
+
+		//if that still is not a simple polygon, fall back to the triangles p lies in
+		if (bRootHidden || !IsSimpleBoundary())
+		{
+			for (size_t i{ numRoots }; i < m_Cavity.size(); ++i)
+			{
+				m_Marks[m_Cavity[i]] = m_Stamp + 1;
+			}
+			m_Cavity.resize(numRoots);
+			CollectBoundary(p, roots, bRootHidden);
+			if (bRootHidden || !IsSimpleBoundary())
+				return false;
+		}
+		return true;
+	}
+
+	int32_t DelaunayMesh::CollectBoundary(const Vec2& p, int32_t numRoots, bool& bRootHidden)
+	{
+		const std::vector<Vec2>& points = *m_pPoints;
+
+		m_Boundary.clear();
+		bRootHidden = false;
+		int32_t numRejected = 0;
+		for (size_t c{ 0 }; c < m_Cavity.size(); ++c)
+		{
+			const MeshTriangle& triangle = m_Triangles[m_Cavity[c]];
+			for (int32_t i{ 0 }; i < 3; ++i)
+			{
+				if (m_Marks[triangle.n[i]] == m_Stamp)
+					continue;
+
+				BoundaryEdge edge;
+				edge.from = triangle.v[(i + 1) % 3];
+				edge.to = triangle.v[(i + 2) % 3];
+				edge.inner = m_Cavity[c];
+				edge.outer = triangle.n[i];
+				m_Boundary.push_back(edge);
+
+				//the new triangle (from, to, p) has to be counter clockwise
+				if (edge.from >= 0 && edge.to >= 0 && Orient(points[edge.from], points[edge.to], p) <= 0.0)
+				{
+					if (static_cast<int32_t>(c) < numRoots)
+					{
+						bRootHidden = true;
+					}
+					else if (m_Marks[edge.inner] == m_Stamp)
+					{
+						m_Marks[edge.inner] = m_Stamp + 1;
+						++numRejected;
+					}
+				}
+			}
+		}
+		return numRejected;
+	}
+
+	bool DelaunayMesh::IsSimpleBoundary()
+	{
+		//a disk with m triangles is bounded by m + 2 edges, and a simple boundary passes each vertex once
+		bool bSimple = m_Boundary.size() == m_Cavity.size() + 2;
+		size_t numChecked = 0;
+		for (; numChecked < m_Boundary.size() && bSimple; ++numChecked)
+		{
+			int32_t& slot = m_FanFrom[m_Boundary[numChecked].from + 1];
+			bSimple = slot < 0;
+			slot = 0;
+		}
+
+		for (size_t i{ 0 }; i < numChecked; ++i)
+		{
+			m_FanFrom[m_Boundary[i].from + 1] = -1;
+		}
+		return bSimple;
+	}
+
+	void DelaunayMesh::KeepConnected(int32_t numRoots)
+	{
+		//everything still in the cavity becomes pending, then only what is reachable from the roots is taken back
+		for (int32_t triangle : m_Cavity)
+		{
+			if (m_Marks[triangle] == m_Stamp)
+				m_Marks[triangle] = m_Stamp + 2;
+		}
+
+		m_Stack.clear();
+		for (int32_t i{ 0 }; i < numRoots; ++i)
+		{
+			m_Marks[m_Cavity[i]] = m_Stamp;
+			m_Stack.push_back(m_Cavity[i]);
+		}
+
+		std::vector<int32_t> previous;
+		previous.swap(m_Cavity);
+		m_Cavity.assign(previous.begin(), previous.begin() + numRoots);
+
+		while (!m_Stack.empty())
+		{
+			const int32_t current = m_Stack.back();
+			m_Stack.pop_back();
+
+			for (int32_t neighbor : m_Triangles[current].n)
+			{
+				if (m_Marks[neighbor] == m_Stamp + 2)
+				{
+					m_Marks[neighbor] = m_Stamp;
+					m_Cavity.push_back(neighbor);
+					m_Stack.push_back(neighbor);
+				}
+			}
+		}
+
+		for (int32_t triangle : previous)
+		{
+			if (m_Marks[triangle] == m_Stamp + 2)
+				m_Marks[triangle] = m_Stamp + 1;
+		}
+	}
+
+	int32_t DelaunayMesh::AllocateTriangle()
+	{
+		if (!m_FreeTriangles.empty())
+		{
+			const int32_t triangle = m_FreeTriangles.back();
+			m_FreeTriangles.pop_back();
+			return triangle;
+		}
+
+		m_Triangles.push_back({ { DeadVertex, DeadVertex, DeadVertex }, { -1, -1, -1 } });
+		if (m_Marks.size() < m_Triangles.size())
+			m_Marks.push_back(0);
+		return static_cast<int32_t>(m_Triangles.size() - 1);
+	}
+
+	void DelaunayMesh::LinkOuter(int32_t outer, int32_t from, int32_t to, int32_t triangle)
+	{
+		//the outer triangle runs the shared edge the other way around
+		MeshTriangle& outerTriangle = m_Triangles[outer];
+		for (int32_t j{ 0 }; j < 3; ++j)
+		{
+			if (outerTriangle.v[(j + 1) % 3] == to && outerTriangle.v[(j + 2) % 3] == from)
+			{
+				outerTriangle.n[j] = triangle;
+				return;
+			}
+		}
+	}
+
+	int32_t DelaunayMesh::FindGhostCorner(const MeshTriangle& triangle) const
+	{
+		for (int32_t i{ 0 }; i < 3; ++i)
+		{
+			if (triangle.v[i] == GhostVertex)
+				return i;
+		}
+		return -1;
+	}
+}
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+namespace DungeonCore
+{
+	//Triangle of the mesh. v are indices into the point buffer, n[i] is the triangle across the edge opposite v[i].
+	//Vertices are counter clockwise. Triangles touching the hull have a ghost vertex instead of a super triangle.
+	struct MeshTriangle
+	{
+		int32_t v[3];
+		int32_t n[3];
+	};
+
+	//Incremental Bowyer-Watson on a neighbor-indexed triangle mesh.
+	//Every point is located by walking from the last inserted triangle, the cavity is grown by BFS over neighbors
+	//and the new fan is stitched in place. Points are inserted along a Hilbert curve so walks stay short,
+	//which gives expected O(n log n) construction.
+	class DelaunayMesh
+	{
+	public:
+		static constexpr int32_t GhostVertex = -1;
+		static constexpr int32_t DeadVertex = -2;
+
+		//triangulates the points. the buffer must stay alive while the mesh is used
+		void Triangulate(const std::vector<Vec2>& points);
+
+		//all the slots, including ghost and dead ones. use IsReal to filter
+		const std::vector<MeshTriangle>& GetTriangles() const { return m_Triangles; }
+		bool IsReal(const MeshTriangle& triangle) const
+		{
+			return triangle.v[0] >= 0 && triangle.v[1] >= 0 && triangle.v[2] >= 0;
+		}
+		int32_t GetNumRealTriangles() const { return m_NumRealTriangles; }
+
+		//when every point is on one line there are no triangles, the points are instead chained in order along the line
+		const std::vector<int32_t>& GetCollinearChain() const { return m_CollinearChain; }
+
+	private:
+		const std::vector<Vec2>* m_pPoints = nullptr;
+
+		std::vector<MeshTriangle> m_Triangles;
+		std::vector<int32_t> m_FreeTriangles;
+		int32_t m_NumRealTriangles = 0;
+		std::vector<int32_t> m_CollinearChain;
+
+		//scratch, kept between calls to avoid reallocating
+		struct BoundaryEdge
+		{
+			int32_t from;
+			int32_t to;
+			int32_t inner;
+			int32_t outer;
+		};
+		std::vector<int32_t> m_InsertOrder;
+		std::vector<uint32_t> m_Marks;
+		uint32_t m_Stamp = 0;
+		std::vector<int32_t> m_Cavity;
+		std::vector<int32_t> m_Stack;
+		std::vector<BoundaryEdge> m_Boundary;
+		std::vector<int32_t> m_NewTriangles;
+		std::vector<int32_t> m_FanFrom;
+
+		void SortInsertOrder();
+		bool CreateFirstTriangle();
+		void InsertPoint(int32_t pointIndex, int32_t& hint);
+
+		int32_t Locate(const Vec2& p, int32_t hint) const;
+		int32_t LocateBruteForce(const Vec2& p) const;
+		bool InConflict(int32_t triangle, const Vec2& p) const;
+		bool GrowCavity(int32_t pointIndex, int32_t start);
+		int32_t CollectBoundary(const Vec2& p, int32_t numRoots, bool& bRootHidden);
+		bool IsSimpleBoundary();
+		void KeepConnected(int32_t numRoots);
+
+		int32_t AllocateTriangle();
+		void LinkOuter(int32_t outer, int32_t from, int32_t to, int32_t triangle);
+		int32_t FindGhostCorner(const MeshTriangle& triangle) const;
+	};
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DisjointSet.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace DungeonCore
+{
+	void DisjointSet::Reset(int32_t numElements)
+	{
+		m_Parent.resize(numElements);
+		std::iota(m_Parent.begin(), m_Parent.end(), 0);
+		m_Rank.assign(numElements, 0);
+		m_NumSets = numElements;
+	}
+
+	int32_t DisjointSet::Find(int32_t element)
+	{
+		//path halving: every other node on the way skips to its grandparent
+		while (m_Parent[element] != element)
+		{
+			m_Parent[element] = m_Parent[m_Parent[element]];
+			element = m_Parent[element];
+		}
+		return element;
+	}
+
+	bool DisjointSet::Union(int32_t a, int32_t b)
+	{
+		int32_t rootA = Find(a);
+		int32_t rootB = Find(b);
+		if (rootA == rootB)
+			return false;
+
+		//the root with the lower rank goes under the other one
+		if (m_Rank[rootA] < m_Rank[rootB])
+			std::swap(rootA, rootB);
+
+		m_Parent[rootB] = rootA;
+		if (m_Rank[rootA] == m_Rank[rootB])
+			++m_Rank[rootA];
+
+		--m_NumSets;
+		return true;
+	}
+}
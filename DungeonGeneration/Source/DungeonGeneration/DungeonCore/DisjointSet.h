@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+namespace DungeonCore
+{
+	//Union-Find over the elements [0, n), two contiguous int32 arrays.
+	//Reset keeps the capacity, so one set can be reused for every generation without allocating.
+	class DisjointSet
+	{
+	public:
+		//every element in its own set
+		void Reset(int32_t numElements);
+
+		//root of the element's set. halves the path on the way up
+		int32_t Find(int32_t element);
+		//merges the sets of a and b, false if they were already in the same set
+		bool Union(int32_t a, int32_t b);
+
+		int32_t GetNumElements() const { return static_cast<int32_t>(m_Parent.size()); }
+		int32_t GetNumSets() const { return m_NumSets; }
+
+	private:
+		std::vector<int32_t> m_Parent;
+		std::vector<int32_t> m_Rank; //upper bound of the tree height, only meaningful for roots
+		int32_t m_NumSets = 0;
+	};
+}
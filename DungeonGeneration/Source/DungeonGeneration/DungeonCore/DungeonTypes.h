@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+//Everything inside DungeonCore is plain C++ and must never include engine headers.
+//The UE classes (AC_Generate, UC_Graph, AC_Grid) are adapters over it, and the headless tools link it directly.
+namespace DungeonCore
+{
+	//2D point, the dungeon lives on the XY plane (Z is always 0 in the actors)
+	struct Vec2
+	{
+		float X = 0.f;
+		float Y = 0.f;
+
+		Vec2() {};
+		Vec2(float x, float y) : X(x), Y(y) {};
+
+		bool operator==(const Vec2& other) const { return X == other.X && Y == other.Y; }
+		bool operator!=(const Vec2& other) const { return !(*this == other); }
+	};
+
+	inline float DistSquared(const Vec2& a, const Vec2& b)
+	{
+		const float dx = b.X - a.X;
+		const float dy = b.Y - a.Y;
+		return dx * dx + dy * dy;
+	}
+
+	inline float Distance(const Vec2& a, const Vec2& b)
+	{
+		return std::sqrt(DistSquared(a, b));
+	}
+
+	//a placed room. its center is always snapped to the center of a grid cell
+	struct Room
+	{
+		Vec2 center;
+		int32_t cellIndex = -1;
+		int32_t width = 0;
+		int32_t depth = 0;
+	};
+
+	enum class PlacementMode : uint8_t
+	{
+		Rejection,   //random centers, redrawn until they clear every room (the original SetCells loop)
+		PoissonDisk  //Bridson sampling around the rooms already placed, stops when no room fits anymore
+	};
+
+	//how the grid routes the corridors, see Grid::SetPathSearch
+	enum class PathSearch : uint8_t
+	{
+		AStar,        //one cell at a time
+		JumpPoint,    //jumps over straight runs of cells, same path length as AStar. only while every step costs the same, AStar otherwise
+		Hierarchical, //HPA*, an abstract graph over clusters of cells searched first. slightly longer paths than AStar, AStar once corridors are discounted
+		Bidirectional //AStar from both ends, meeting in the middle. same path length as AStar, AStar once corridors are discounted
+	};
+
+	//all the knobs SetCells used to hardcode
+	struct GenerationParams
+	{
+		int32_t numberRooms = 3;
+
+		//grid
+		int32_t nrRows = 100;
+		int32_t nrColumns = 100;
+		float cellWidth = 100.f;
+		float cellDepth = 100.f;
+
+		//rooms
+		int32_t minRoomSize = 300;
+		int32_t maxRoomSize = 600;
+		float roomMargin = 200.f;
+		int32_t maxPlacementAttempts = 1000; //tries per room before placement gives up
+		PlacementMode placementMode = PlacementMode::Rejection;
+		int32_t poissonCandidates = 30; //candidates around an active room before it is retired
+
+		//corridors
+		float corridorCostScale = 1.f; //cost of stepping onto an existing corridor, below 1 merges corridors
+		PathSearch corridorSearch = PathSearch::AStar;
+		float loopEdgeRatio = 0.f; //fraction of the triangulation edges left out of the MST that get a corridor anyway, 0 keeps the dungeon a tree
+	};
+}
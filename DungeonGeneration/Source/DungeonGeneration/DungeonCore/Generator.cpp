@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Generator.h"
+#include "RandomStream.h"
+
+#include <chrono>
+
+namespace DungeonCore
+{
+	Generator::Generator(const GenerationParams& params)
+		: m_Params(params),
+		m_Grid(params.nrRows, params.nrColumns, params.cellWidth, params.cellDepth)
+	{
+		m_Grid.SetPathSearch(params.corridorSearch);
+	}
+
+	const DungeonLayout& Generator::Generate(uint64_t seed)
+	{
+		Begin(seed);
+		while (!IsDone())
+		{
+			RunNext();
+		}
+		return m_Layout;
+	}
+
+	void Generator::Begin(uint64_t seed)
+	{
+		m_Stats = GenerationStats();
+		m_Layout.seed = seed;
+		m_NextStage = Stage::Placement;
+		m_NextRequest = 0;
+	}
+
+	bool Generator::Step(double budgetMs)
+	{
+		//at least one piece per step, or a tiny budget would never finish
+		const auto start = std::chrono::steady_clock::now();
+		while (!IsDone())
+		{
+			RunNext();
+
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() >= budgetMs)
+				break;
+		}
+		return IsDone();
+	}
+
+	void Generator::RunNext()
+	{
+		const uint64_t seed = m_Layout.seed;
+		ScopedStage stage(m_Stats, m_NextStage, m_pStatsSink);
+
+		switch (m_NextStage)
+		{
+		case Stage::Placement:
+		{
+			m_Grid.EmptyCells();
+			RandomStream placementStream(seed, SeedStream::Placement);
+			RandomStream sizeStream(seed, SeedStream::Sizes);
+			m_Layout.allRoomsPlaced = PlaceRooms(m_Params, m_Grid, placementStream, sizeStream, m_Layout.rooms, m_RoomHash);
+			m_NextStage = Stage::Triangulation;
+			break;
+		}
+
+		case Stage::Triangulation:
+			//points for triangulation will be the rooms center
+			m_Graph.DeletePoints();
+			for (const Room& room : m_Layout.rooms)
+			{
+				m_Graph.AddPoint(room.center);
+			}
+			m_Graph.TriangulationAlgorithm();
+			m_NextStage = Stage::Edges;
+			break;
+
+		case Stage::Edges:
+			m_Graph.GetEdges();
+			m_NextStage = Stage::Nodes;
+			break;
+
+		case Stage::Nodes:
+			m_Graph.CreateNodes();
+			m_NextStage = Stage::MST;
+			break;
+
+		case Stage::MST:
+			m_Graph.FindMinimumSpanningTree();
+			m_NextStage = Stage::Loops;
+			break;
+
+		case Stage::Loops:
+		{
+			RandomStream loopStream(seed, SeedStream::Loops);
+			m_Graph.AddLoopEdges(m_Params.loopEdgeRatio, loopStream);
+			m_NextStage = Stage::Path;
+			break;
+		}
+
+		case Stage::Path:
+			if (m_NextRequest == 0)
+				BuildPathRequests();
+
+			//the parallel search needs the whole batch, the serial one is FindPath request by request
+			if (m_pExecutor != nullptr)
+			{
+				m_Grid.FindPaths(m_PathRequests, m_Params.corridorCostScale, m_Layout.corridors, m_pExecutor);
+				m_NextRequest = m_PathRequests.size();
+			}
+			else if (m_NextRequest < m_PathRequests.size())
+			{
+				m_Grid.FindPath(m_PathRequests[m_NextRequest], m_Params.corridorCostScale, m_Layout.corridors[m_NextRequest]);
+				++m_NextRequest;
+			}
+
+			if (m_NextRequest >= m_PathRequests.size())
+			{
+				m_Layout.triangulationEdges = m_Graph.GetTriangulationEdges();
+				m_Layout.mstEdges = m_Graph.GetMSTEdges();
+				m_Layout.loopEdges = m_Graph.GetLoopEdges();
+				m_NextStage = Stage::Count;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void Generator::BuildPathRequests()
+	{
+		//one corridor per MST and loop edge, routed together so they can share hallways.
+		//the salts are drawn here in request order, so which worker runs a search doesn't matter
+		RandomStream corridorStream(m_Layout.seed, SeedStream::Corridors);
+		const std::vector<Vec2>& points = m_Graph.GetPoints();
+		m_PathRequests.clear();
+		for (const std::vector<TriangulationEdge>* pEdges : { &m_Graph.GetMSTEdges(), &m_Graph.GetLoopEdges() })
+		{
+			for (const TriangulationEdge& edge : *pEdges)
+			{
+				m_PathRequests.push_back({ m_Grid.GetCellIndex(points[edge.vertex[0]]), m_Grid.GetCellIndex(points[edge.vertex[1]]), corridorStream.GetUnsignedInt() });
+			}
+		}
+		m_Layout.corridors.resize(m_PathRequests.size());
+	}
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "Graph.h"
+#include "Grid.h"
+#include "RoomPlacement.h"
+#include "Stats.h"
+
+namespace DungeonCore
+{
+	//everything a generation produces, nothing engine related
+	struct DungeonLayout
+	{
+		//the layout is a pure function of the seed and the params, whatever the executor
+		uint64_t seed = 0;
+		std::vector<Room> rooms;
+		//false if the grid was too crowded for params.numberRooms, the layout is then built from the rooms that fit
+		bool allRoomsPlaced = true;
+		//edge vertices are room indices
+		std::vector<TriangulationEdge> triangulationEdges;
+		std::vector<TriangulationEdge> mstEdges;
+		//non-MST triangulation edges picked by params.loopEdgeRatio
+		std::vector<TriangulationEdge> loopEdges;
+		//one cell path per MST edge, then one per loop edge, start to end
+		std::vector<std::vector<int32_t>> corridors;
+	};
+
+	//Runs every stage of a generation, headless. AC_Generate shows what it produces, GenerateFromSeed and GenerateAsync each run one.
+	//The grid and graph are kept between calls so repeated generations reuse their memory.
+	class Generator
+	{
+	public:
+		explicit Generator(const GenerationParams& params);
+
+		//every stage draws from its own stream of the seed, see SeedStream
+		const DungeonLayout& Generate(uint64_t seed);
+
+		//Same generation split into steps, for callers that can't block: Begin, then Step until it returns true.
+		//A step runs whole stages, and corridors one at a time, until budgetMs has passed. A single stage is never split,
+		//so a step can overrun by the longest one. With an executor the corridors are routed in one go.
+		//the layout is the same as Generate's
+		void Begin(uint64_t seed);
+		bool Step(double budgetMs);
+		bool IsDone() const { return m_NextStage == Stage::Count; }
+
+		const GenerationParams& GetParams() const { return m_Params; }
+		//time and allocations of each stage of the last Generate
+		const GenerationStats& GetStats() const { return m_Stats; }
+		const DungeonLayout& GetLayout() const { return m_Layout; }
+		const Grid& GetGrid() const { return m_Grid; }
+		const Graph& GetGraph() const { return m_Graph; }
+
+		//takes over the cell costs of a grid of the same size, like the one on screen, for the next Generate or Begin. false if the sizes differ
+		bool CopyCellCosts(const Grid& source) { return m_Grid.CopyCellCosts(source); }
+
+		//spreads the corridor searches over the executor's workers, nullptr runs them serially. the output is the same either way
+		void SetExecutor(ParallelExecutor* pExecutor) { m_pExecutor = pExecutor; }
+		//reports every stage to the sink, nullptr only times them
+		void SetStatsSink(StatsSink* pSink) { m_pStatsSink = pSink; }
+
+	private:
+		GenerationParams m_Params;
+		Grid m_Grid;
+		Graph m_Graph;
+
+		ParallelExecutor* m_pExecutor = nullptr;
+		StatsSink* m_pStatsSink = nullptr;
+		RoomSpatialHash m_RoomHash;
+		std::vector<PathRequest> m_PathRequests;
+		DungeonLayout m_Layout;
+		GenerationStats m_Stats;
+
+		//where Step picks up
+		Stage m_NextStage = Stage::Count;
+		size_t m_NextRequest = 0;
+
+		//runs the next stage, or the next corridor of the path stage, and moves on
+		void RunNext();
+		void BuildPathRequests();
+	};
+}
@@ -0,0 +1,297 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace DungeonCore
+{
+	//passed by reference to assign, needs a definition before C++17
+	constexpr uint64_t Graph::EmptyEdgeKey;
+
+	Triangle::Triangle(const std::vector<Vec2>& points, int32_t v1, int32_t v2, int32_t v3)
+	{
+		vertices[0] = v1; //first point will be added
+
+		//figure if triangle is being added clock or counter clockwise and store it counter clockwise
+		const Vec2& p1 = points[v1];
+		const Vec2& p2 = points[v2];
+		const Vec2& p3 = points[v3];
+		const float orientation = (p2.X - p1.X) * (p3.Y - p1.Y) - (p3.X - p1.X) * (p2.Y - p1.Y);
+		const bool isCounterClockwise = orientation > 0;
+		vertices[1] = isCounterClockwise ? v2 : v3;
+		vertices[2] = isCounterClockwise ? v3 : v2;
+
+		//circumcenter relative to the first point, in double so far away points keep their precision
+		const double bx = static_cast<double>(p2.X) - p1.X, by = static_cast<double>(p2.Y) - p1.Y;
+		const double cx = static_cast<double>(p3.X) - p1.X, cy = static_cast<double>(p3.Y) - p1.Y;
+
+		const double bLift = bx * bx + by * by;
+		const double cLift = cx * cx + cy * cy;
+		const double d = 2 * (bx * cy - by * cx);
+
+		const double ux = (cy * bLift - by * cLift) / d;
+		const double uy = (bx * cLift - cx * bLift) / d;
+
+		circumCenter = Vec2(static_cast<float>(p1.X + ux), static_cast<float>(p1.Y + uy));
+		circumRadiusSquared = static_cast<float>(ux * ux + uy * uy);
+	}
+
+	void Graph::SetPointsArray(const std::vector<Vec2>& points)
+	{
+		DeletePoints();
+		m_Locations = points;
+	}
+
+	void Graph::AddPoint(const Vec2& point)
+	{
+		m_Locations.push_back(point);
+	}
+
+	void Graph::DeletePoints()
+	{
+		m_Locations.clear();
+
+		//everything else holds point indices
+		m_TriangulationTrianglesArray.clear();
+		m_TriangulationEdgesArray.clear();
+		m_MSTEdgesArray.clear();
+		m_LoopEdgesArray.clear();
+	}
+
+	void Graph::TriangulationAlgorithm()
+	{
+		m_TriangulationTrianglesArray.clear();
+
+		m_Mesh.Triangulate(m_Locations);
+
+		//only the triangles between real points, the ghost ones just close the hull
+		m_TriangulationTrianglesArray.reserve(m_Mesh.GetNumRealTriangles());
+		for (const MeshTriangle& triangle : m_Mesh.GetTriangles())
+		{
+			if (!m_Mesh.IsReal(triangle))
+				continue;
+
+			m_TriangulationTrianglesArray.push_back(Triangle(m_Locations, triangle.v[0], triangle.v[1], triangle.v[2]));
+		}
+	}
+
+	void Graph::GetEdges()
+	{
+		m_TriangulationEdgesArray.clear();
+
+		//every edge is in at most two triangles, keep the set at most half full
+		size_t capacity = 16;
+		while (capacity < m_TriangulationTrianglesArray.size() * 6)
+			capacity *= 2;
+		m_EdgeKeys.assign(capacity, EmptyEdgeKey);
+
+		//loop over all triangles
+		for (const Triangle& triangle : m_TriangulationTrianglesArray)
+		{
+			for (int32_t i{ 0 }; i < 3; ++i)
+			{
+				const int32_t v1 = triangle.vertices[i];
+				const int32_t v2 = triangle.vertices[(i + 1) % 3];
+
+				//add only unique edges, shared edges appear in two triangles
+				if (InsertEdgeKey(v1, v2))
+					m_TriangulationEdgesArray.push_back(MakeEdge(v1, v2));
+			}
+		}
+
+		//every point on one line, there are no triangles but the rooms still have to be connected
+		const std::vector<int32_t>& chain = m_Mesh.GetCollinearChain();
+		for (size_t i{ 1 }; i < chain.size(); ++i)
+		{
+			m_TriangulationEdgesArray.push_back(MakeEdge(chain[i - 1], chain[i]));
+		}
+	}
+
+	void Graph::CreateNodes()
+	{
+		//one node per point, the edges already know their points
+		const size_t numNodes = m_Locations.size();
+
+		//count the edges of each node, then turn the counts into offsets
+		m_NodeOffsets.assign(numNodes + 1, 0);
+		for (const TriangulationEdge& edge : m_TriangulationEdgesArray)
+		{
+			++m_NodeOffsets[edge.vertex[0] + 1];
+			++m_NodeOffsets[edge.vertex[1] + 1];
+		}
+		for (size_t i{ 0 }; i < numNodes; ++i)
+		{
+			m_NodeOffsets[i + 1] += m_NodeOffsets[i];
+		}
+
+		//fill every node's range in edge order
+		m_NodeEdges.resize(m_NodeOffsets[numNodes]);
+		m_NodeCursor.assign(m_NodeOffsets.begin(), m_NodeOffsets.end() - 1);
+		for (size_t i{ 0 }; i < m_TriangulationEdgesArray.size(); ++i)
+		{
+			const TriangulationEdge& edge = m_TriangulationEdgesArray[i];
+
+			//add the edge to the connection list of both nodes
+			m_NodeEdges[m_NodeCursor[edge.vertex[0]]++] = static_cast<int32_t>(i);
+			m_NodeEdges[m_NodeCursor[edge.vertex[1]]++] = static_cast<int32_t>(i);
+		}
+	}
+
+	void Graph::FindMinimumSpanningTree(EdgeSort sort)
+	{
+		m_MSTEdgesArray.clear();
+		m_LoopEdgesArray.clear();
+		m_IsTreeEdge.assign(m_TriangulationEdgesArray.size(), 0);
+
+		const int32_t numNodes = static_cast<int32_t>(m_Locations.size());
+		m_Components.Reset(numNodes);
+
+		// Sort the edges based on their cost in non-decreasing order.
+		if (sort == EdgeSort::Radix)
+			SortEdgesRadix();
+		else
+			SortEdgesComparison();
+
+		for (int32_t edgeIndex : m_SortedEdges)
+		{
+			const TriangulationEdge& edge = m_TriangulationEdgesArray[edgeIndex];
+
+			// Including this edge would create a cycle if both ends are already connected.
+			if (m_Components.Union(edge.vertex[0], edge.vertex[1]))
+			{
+				m_MSTEdgesArray.push_back(edge);
+				m_IsTreeEdge[edgeIndex] = 1;
+
+				if (m_Components.GetNumSets() == 1)
+					break; // Minimum spanning tree found.
+			}
+		}
+	}
+
+	void Graph::AddLoopEdges(float ratio, RandomStream& randomStream)
+	{
+		m_LoopEdgesArray.clear();
+
+		const int32_t numCandidates = static_cast<int32_t>(m_TriangulationEdgesArray.size() - m_MSTEdgesArray.size());
+		int32_t numNeeded = static_cast<int32_t>(std::lround(std::min(std::max(ratio, 0.f), 1.f) * numCandidates));
+		if (numNeeded <= 0)
+			return;
+
+		//selection sampling: each candidate is taken with probability needed / remaining, which gives exactly numNeeded
+		m_LoopEdgesArray.reserve(numNeeded);
+		int32_t numRemaining = numCandidates;
+		for (size_t i{ 0 }; i < m_TriangulationEdgesArray.size() && numNeeded > 0; ++i)
+		{
+			if (m_IsTreeEdge[i])
+				continue;
+
+			if (numNeeded == numRemaining || randomStream.RandHelper(numRemaining) < numNeeded)
+			{
+				m_LoopEdgesArray.push_back(m_TriangulationEdgesArray[i]);
+				--numNeeded;
+			}
+			--numRemaining;
+		}
+	}
+
+	void Graph::SortEdgesComparison()
+	{
+		//equal costs fall back to the edge index so the order is the same on every platform
+		m_SortedEdges.resize(m_TriangulationEdgesArray.size());
+		std::iota(m_SortedEdges.begin(), m_SortedEdges.end(), 0);
+		std::sort(m_SortedEdges.begin(), m_SortedEdges.end(), [this](int32_t edgeA, int32_t edgeB)
+			{
+				const float costA = m_TriangulationEdgesArray[edgeA].cost;
+				const float costB = m_TriangulationEdgesArray[edgeB].cost;
+				return costA != costB ? costA < costB : edgeA < edgeB;
+			});
+	}
+
+	void Graph::SortEdgesRadix()
+	{
+		//the bits of a non negative float sort the same way as its value, so the cost is the integer key.
+		//the edge index rides along in the low half and, since every pass is stable, breaks the ties
+		const size_t numEdges = m_TriangulationEdgesArray.size();
+		m_SortKeys.resize(numEdges);
+		m_SortKeysScratch.resize(numEdges);
+		for (size_t i{ 0 }; i < numEdges; ++i)
+		{
+			uint32_t costBits;
+			std::memcpy(&costBits, &m_TriangulationEdgesArray[i].cost, sizeof(costBits));
+			m_SortKeys[i] = (static_cast<uint64_t>(costBits) << 32) | static_cast<uint32_t>(i);
+		}
+
+		//three passes of 11 bits over the 32 cost bits
+		constexpr int32_t radixBits = 11;
+		constexpr uint32_t radixMask = (1u << radixBits) - 1;
+		for (int32_t shift{ 32 }; shift < 64; shift += radixBits)
+		{
+			size_t counts[radixMask + 1] = {};
+			for (uint64_t key : m_SortKeys)
+			{
+				++counts[(key >> shift) & radixMask];
+			}
+
+			//every key has the same digit, nothing to move
+			if (numEdges == 0 || counts[(m_SortKeys[0] >> shift) & radixMask] == numEdges)
+				continue;
+
+			size_t offset = 0;
+			for (size_t& count : counts)
+			{
+				const size_t bucketSize = count;
+				count = offset;
+				offset += bucketSize;
+			}
+			for (uint64_t key : m_SortKeys)
+			{
+				m_SortKeysScratch[counts[(key >> shift) & radixMask]++] = key;
+			}
+			m_SortKeys.swap(m_SortKeysScratch);
+		}
+
+		m_SortedEdges.resize(numEdges);
+		for (size_t i{ 0 }; i < numEdges; ++i)
+		{
+			m_SortedEdges[i] = static_cast<int32_t>(m_SortKeys[i] & 0xFFFFFFFFu);
+		}
+	}
+
+	size_t Graph::GetTriangulationBytes() const
+	{
+		return m_Mesh.GetTriangles().capacity() * sizeof(MeshTriangle)
+			+ m_TriangulationTrianglesArray.capacity() * sizeof(Triangle);
+	}
+
+	bool Graph::InsertEdgeKey(int32_t v1, int32_t v2)
+	{
+		//the smaller index first so both directions pack to the same key
+		const uint64_t low = static_cast<uint32_t>(std::min(v1, v2));
+		const uint64_t high = static_cast<uint32_t>(std::max(v1, v2));
+		const uint64_t key = (high << 32) | low;
+
+		//fibonacci hashing then linear probing, the capacity is a power of two
+		const size_t mask = m_EdgeKeys.size() - 1;
+		for (size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask; ; slot = (slot + 1) & mask)
+		{
+			if (m_EdgeKeys[slot] == key)
+				return false;
+
+			if (m_EdgeKeys[slot] == EmptyEdgeKey)
+			{
+				m_EdgeKeys[slot] = key;
+				return true;
+			}
+		}
+	}
+
+	TriangulationEdge Graph::MakeEdge(int32_t v1, int32_t v2) const
+	{
+		return TriangulationEdge(v1, v2, Distance(m_Locations[v1], m_Locations[v2]));
+	}
+}
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "Delaunay.h"
+#include "DisjointSet.h"
+#include "RandomStream.h"
+
+namespace DungeonCore
+{
+	//Plain data, no allocation. Vertices are indices into the graph's point buffer (the rooms, in order).
+	struct TriangulationEdge
+	{
+		int32_t vertex[2] = { -1, -1 };
+		float cost = 0.f; //length of the edge
+
+		TriangulationEdge() {};
+		TriangulationEdge(int32_t v1, int32_t v2, float length)
+		{
+			vertex[0] = v1;
+			vertex[1] = v2;
+			cost = length;
+		}
+
+		//edges are undirected
+		bool operator==(const TriangulationEdge& other) const
+		{
+			return (vertex[0] == other.vertex[0] && vertex[1] == other.vertex[1])
+				|| (vertex[0] == other.vertex[1] && vertex[1] == other.vertex[0]);
+		}
+	};
+
+	//Plain data, no allocation. Edge i runs from vertices[i] to vertices[(i + 1) % 3].
+	struct Triangle
+	{
+		int32_t vertices[3] = { -1, -1, -1 }; //indices into the point buffer, counter clockwise
+
+		Vec2 circumCenter; //the center of the circle through the three points
+		float circumRadiusSquared = 0.f;
+
+		Triangle() {};
+		Triangle(const std::vector<Vec2>& points, int32_t v1, int32_t v2, int32_t v3);
+
+		bool HasVertex(int32_t point) const
+		{
+			return vertices[0] == point || vertices[1] == point || vertices[2] == point;
+		}
+		bool IsPointInsideCircumcircle(const Vec2& p) const
+		{
+			return DistSquared(p, circumCenter) < circumRadiusSquared;
+		}
+	};
+
+	//how FindMinimumSpanningTree orders the edges, both give the same tree
+	enum class EdgeSort : uint8_t
+	{
+		Comparison, //std::sort on the float costs, O(E log E)
+		Radix       //LSD radix sort on the integer bits of the costs, O(E)
+	};
+
+	//Engine-free Delaunay triangulation + minimum spanning tree. UC_Graph keeps a copy of the last one for the debug drawing.
+	class Graph
+	{
+	public:
+		void SetPointsArray(const std::vector<Vec2>& points);
+		void AddPoint(const Vec2& point);
+		//removes the points and the triangulation and trees built on them
+		void DeletePoints();
+		const std::vector<Vec2>& GetPoints() const { return m_Locations; }
+
+		//incremental Bowyer-Watson over the points, see DelaunayMesh
+		void TriangulationAlgorithm();
+		//collects the unique edges of the triangulation, deduplicated through a hash of their packed point indices.
+		//collinear points are chained along their line instead
+		void GetEdges();
+		//links the edges to the points. node i is point i, its edges are
+		//GetNodeEdges()[GetNodeOffsets()[i]] up to GetNodeEdges()[GetNodeOffsets()[i + 1]]
+		void CreateNodes();
+		//Kruskal over the triangulation edges, sorted as indices so the edges themselves are never copied.
+		//the tree is a list of point index pairs, ties in cost go to the lower edge index with either sort
+		void FindMinimumSpanningTree(EdgeSort sort = EdgeSort::Radix);
+		//picks round(ratio * candidates) of the triangulation edges that are not in the MST, uniformly and in edge order.
+		//one pass over the edges already in memory, call it after FindMinimumSpanningTree
+		void AddLoopEdges(float ratio, RandomStream& randomStream);
+
+		const std::vector<Triangle>& GetTriangles() const { return m_TriangulationTrianglesArray; }
+		const std::vector<TriangulationEdge>& GetTriangulationEdges() const { return m_TriangulationEdgesArray; }
+		const std::vector<int32_t>& GetNodeOffsets() const { return m_NodeOffsets; }
+		const std::vector<int32_t>& GetNodeEdges() const { return m_NodeEdges; }
+		const std::vector<TriangulationEdge>& GetMSTEdges() const { return m_MSTEdgesArray; }
+		const std::vector<TriangulationEdge>& GetLoopEdges() const { return m_LoopEdgesArray; }
+
+		//bytes held by the mesh and the triangle array, capacity included
+		size_t GetTriangulationBytes() const;
+
+	private:
+		std::vector<Vec2> m_Locations;
+
+		DelaunayMesh m_Mesh;
+		std::vector<Triangle> m_TriangulationTrianglesArray;
+		std::vector<TriangulationEdge> m_TriangulationEdgesArray;
+		std::vector<TriangulationEdge> m_MSTEdgesArray;
+		std::vector<TriangulationEdge> m_LoopEdgesArray;
+		std::vector<uint8_t> m_IsTreeEdge; //1 for the triangulation edges the MST took
+
+		std::vector<int32_t> m_NodeOffsets; //numNodes + 1 entries
+		std::vector<int32_t> m_NodeEdges;   //edge indices, grouped by node
+
+		//open addressing set of packed point pairs and the CSR fill cursor, reused between calls
+		static constexpr uint64_t EmptyEdgeKey = ~0ULL;
+		std::vector<uint64_t> m_EdgeKeys;
+		std::vector<int32_t> m_NodeCursor;
+
+		//Kruskal state, reused between calls
+		std::vector<int32_t> m_SortedEdges;
+		std::vector<uint64_t> m_SortKeys; //cost bits in the high half, edge index in the low half
+		std::vector<uint64_t> m_SortKeysScratch;
+		DisjointSet m_Components;
+
+		//HELPERS
+		TriangulationEdge MakeEdge(int32_t v1, int32_t v2) const;
+		//true the first time an undirected pair is seen since the set was cleared
+		bool InsertEdgeKey(int32_t v1, int32_t v2);
+		//fills m_SortedEdges with the edge indices by cost
+		void SortEdgesComparison();
+		void SortEdgesRadix();
+	};
+}
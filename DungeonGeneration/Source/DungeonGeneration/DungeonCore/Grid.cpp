@@ -0,0 +1,524 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Grid.h"
+#include "JumpPointSearch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+namespace DungeonCore
+{
+	constexpr float Grid::BlockedCost;
+
+	Grid::Grid(int32_t nrRows, int32_t nrColumns, float width, float depth)
+	{
+		Resize(nrRows, nrColumns, width, depth);
+	}
+
+	bool Grid::Resize(int32_t nrRows, int32_t nrColumns, float width, float depth)
+	{
+		//the product is taken in 64 bits, in 32 it wraps long before the allocations fail
+		const int64_t numCells = static_cast<int64_t>(nrRows) * nrColumns;
+		const bool bValid = nrRows >= 0 && nrColumns >= 0 && numCells <= MaxCells;
+		m_NrRow = bValid ? nrRows : 0;
+		m_NrColumns = bValid ? nrColumns : 0;
+		m_Width = width;
+		m_Depth = depth;
+		m_NumCells = bValid ? static_cast<int32_t>(numCells) : 0;
+
+		//the cells themselves only exist as state, the geometry comes from the index
+		const size_t numChunks = (static_cast<size_t>(m_NumCells) + GridChunk::ChunkMask) >> GridChunk::ChunkBits;
+		m_Chunks.clear();
+		m_Chunks.resize(numChunks);
+		for (GridChunk& chunk : m_Chunks)
+		{
+			std::fill(std::begin(chunk.types), std::end(chunk.types), static_cast<uint8_t>(CellType::Empty));
+			std::fill(std::begin(chunk.corridorBits), std::end(chunk.corridorBits), 0ULL);
+		}
+		m_DirtyChunks.clear();
+		m_NumCorridorCells = 0;
+
+		//the costs went with the chunks
+		m_NumWeightedCells = 0;
+		m_Hierarchy.Reset(nrRows, nrColumns);
+		m_BlockedRowsByColumn.clear();
+		m_BlockedColumnsByRow.clear();
+		m_ColumnsWithBlockedCells.clear();
+
+		return bValid;
+	}
+
+	Cell Grid::GetCell(int32_t index) const
+	{
+		Cell cell;
+		cell.bottomLeft = GetCellBottomLeft(index);
+		cell.center = GetCellCenter(index);
+		cell.width = m_Width;
+		cell.depth = m_Depth;
+		cell.type = GetCellType(index);
+		cell.cost = GetCellCost(index);
+		cell.isEmpty = IsEmpty(index);
+		cell.index = index;
+		cell.isCorridor = IsCorridor(index);
+		return cell;
+	}
+
+	GridChunk& Grid::GetChunkForWrite(int32_t index)
+	{
+		GridChunk& chunk = GetChunk(index);
+		if (!chunk.bDirty)
+		{
+			chunk.bDirty = true;
+			m_DirtyChunks.push_back(index >> GridChunk::ChunkBits);
+		}
+		return chunk;
+	}
+
+	void Grid::SetRoom(int32_t index)
+	{
+		GetChunkForWrite(index).types[index & GridChunk::ChunkMask] = static_cast<uint8_t>(CellType::Room);
+	}
+
+	void Grid::SetCellCost(int32_t index, float cost)
+	{
+		const float oldCost = GetCellCost(index);
+		if (oldCost == cost)
+			return;
+
+		GridChunk& chunk = GetChunk(index);
+		if (chunk.costs.empty())
+			chunk.costs.assign(GridChunk::ChunkSize, 1.f);
+		chunk.costs[index & GridChunk::ChunkMask] = cost;
+		m_Hierarchy.Invalidate(index);
+
+		if (oldCost == BlockedCost)
+			RemoveBlockedCell(index);
+		else if (oldCost != 1.f)
+			--m_NumWeightedCells;
+
+		if (cost == BlockedCost)
+			AddBlockedCell(index);
+		else if (cost != 1.f)
+			++m_NumWeightedCells;
+	}
+
+	const std::vector<int32_t>& Grid::GetBlockedRows(int32_t column) const
+	{
+		static const std::vector<int32_t> none;
+		return m_BlockedRowsByColumn.empty() ? none : m_BlockedRowsByColumn[column];
+	}
+
+	const std::vector<int32_t>& Grid::GetBlockedColumns(int32_t row) const
+	{
+		static const std::vector<int32_t> none;
+		return m_BlockedColumnsByRow.empty() ? none : m_BlockedColumnsByRow[row];
+	}
+
+	void Grid::AddBlockedCell(int32_t index)
+	{
+		if (m_BlockedRowsByColumn.empty())
+		{
+			m_BlockedRowsByColumn.resize(m_NrColumns);
+			m_BlockedColumnsByRow.resize(m_NrRow);
+		}
+
+		const int32_t column = index % m_NrColumns;
+		const int32_t row = index / m_NrColumns;
+		std::vector<int32_t>& rows = m_BlockedRowsByColumn[column];
+		if (rows.empty())
+			m_ColumnsWithBlockedCells.insert(std::lower_bound(m_ColumnsWithBlockedCells.begin(), m_ColumnsWithBlockedCells.end(), column), column);
+		rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+		std::vector<int32_t>& columns = m_BlockedColumnsByRow[row];
+		columns.insert(std::lower_bound(columns.begin(), columns.end(), column), column);
+	}
+
+	void Grid::RemoveBlockedCell(int32_t index)
+	{
+		const int32_t column = index % m_NrColumns;
+		const int32_t row = index / m_NrColumns;
+		std::vector<int32_t>& rows = m_BlockedRowsByColumn[column];
+		rows.erase(std::lower_bound(rows.begin(), rows.end(), row));
+		if (rows.empty())
+			m_ColumnsWithBlockedCells.erase(std::lower_bound(m_ColumnsWithBlockedCells.begin(), m_ColumnsWithBlockedCells.end(), column));
+		std::vector<int32_t>& columns = m_BlockedColumnsByRow[row];
+		columns.erase(std::lower_bound(columns.begin(), columns.end(), column));
+	}
+
+	bool Grid::AStarPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath)
+	{
+		return AStarPath(startIndex, endIndex, outPath, m_Scratch.path);
+	}
+
+	bool Grid::AStarPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch) const
+	{
+		return AStarSearch({ startIndex, endIndex }, 1.f, outPath, scratch);
+	}
+
+	bool Grid::JumpPointPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath)
+	{
+		return JumpPointPath(startIndex, endIndex, outPath, m_Scratch.path);
+	}
+
+	bool Grid::JumpPointPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch) const
+	{
+		if (!HasUniformCost(1.f))
+			return AStarSearch({ startIndex, endIndex }, 1.f, outPath, scratch);
+		return FindJumpPointPath(*this, { startIndex, endIndex }, outPath, scratch);
+	}
+
+	bool Grid::HierarchicalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath)
+	{
+		UpdateHierarchy();
+		return HierarchicalPath(startIndex, endIndex, outPath, m_Scratch.path, m_Scratch.hierarchical);
+	}
+
+	bool Grid::HierarchicalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch,
+		HierarchicalScratch& hierarchicalScratch) const
+	{
+		if (!m_Hierarchy.IsCurrent())
+			return AStarSearch({ startIndex, endIndex }, 1.f, outPath, scratch);
+		return m_Hierarchy.FindPath(*this, { startIndex, endIndex }, outPath, scratch, hierarchicalScratch);
+	}
+
+	bool Grid::BidirectionalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath)
+	{
+		return BidirectionalPath(startIndex, endIndex, outPath, m_Scratch.path, m_Scratch.backward);
+	}
+
+	bool Grid::BidirectionalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& forward, PathScratch& backward) const
+	{
+		return BidirectionalSearch({ startIndex, endIndex }, outPath, forward, backward);
+	}
+
+	bool Grid::FindPaths(const std::vector<PathRequest>& requests, float corridorCostScale, std::vector<std::vector<int32_t>>& outPaths,
+		ParallelExecutor* pExecutor)
+	{
+		outPaths.resize(requests.size());
+		if (m_PathSearch == PathSearch::Hierarchical)
+			UpdateHierarchy();
+
+		//discounted corridors make every path depend on the ones before it
+		const bool bParallel = pExecutor != nullptr && pExecutor->GetNumWorkers() > 1 && corridorCostScale == 1.f && requests.size() > 1;
+		if (bParallel)
+		{
+			m_WorkerScratch.resize(pExecutor->GetNumWorkers());
+			m_PathFound.assign(requests.size(), 0);
+
+			pExecutor->For(static_cast<int32_t>(requests.size()), [this, &requests, &outPaths](int32_t index, int32_t worker)
+				{
+					m_PathFound[index] = Search(requests[index], 1.f, outPaths[index], m_WorkerScratch[worker]);
+				});
+
+			//merge in request order
+			bool bAllFound = true;
+			for (size_t i{ 0 }; i < requests.size(); ++i)
+			{
+				if (m_PathFound[i])
+					MarkCorridor(outPaths[i]);
+				else
+					bAllFound = false;
+			}
+			return bAllFound;
+		}
+
+		bool bAllFound = true;
+		for (size_t i{ 0 }; i < requests.size(); ++i)
+		{
+			bAllFound = FindPath(requests[i], corridorCostScale, outPaths[i]) && bAllFound;
+		}
+		return bAllFound;
+	}
+
+	bool Grid::FindPath(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath)
+	{
+		if (m_PathSearch == PathSearch::Hierarchical)
+			UpdateHierarchy();
+		if (!Search(request, corridorCostScale, outPath, m_Scratch))
+			return false;
+
+		//the next paths see this one
+		MarkCorridor(outPath);
+		return true;
+	}
+
+	bool Grid::Search(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath, SearchScratch& scratch) const
+	{
+		//jump point search skips cells, it only sees the cost of a step when all of them cost the same
+		if (m_PathSearch == PathSearch::JumpPoint && HasUniformCost(corridorCostScale))
+			return FindJumpPointPath(*this, request, outPath, scratch.path);
+
+		//the abstract graph holds the cell costs, not the corridor discount. the bidirectional stopping rule needs a heuristic
+		//that never overestimates, which the discount breaks
+		const bool bCorridorsCostTheSame = corridorCostScale == 1.f || m_NumCorridorCells == 0;
+		if (m_PathSearch == PathSearch::Hierarchical && bCorridorsCostTheSame && m_Hierarchy.IsCurrent())
+			return m_Hierarchy.FindPath(*this, request, outPath, scratch.path, scratch.hierarchical);
+		if (m_PathSearch == PathSearch::Bidirectional && bCorridorsCostTheSame)
+			return BidirectionalSearch(request, outPath, scratch.path, scratch.backward);
+		return AStarSearch(request, corridorCostScale, outPath, scratch.path);
+	}
+
+	bool Grid::AStarSearch(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath, PathScratch& scratch) const
+	{
+		outPath.clear();
+
+		const int32_t startIndex = request.start;
+		const int32_t endIndex = request.end;
+
+		//the heuristic counts cells and is not scaled down for discounted corridors. that makes the search weighted,
+		//at most 1 / corridorCostScale off the cheapest path, but it keeps the expansions as low as a plain search.
+		//scaling it down to stay admissible expands most of the grid between the rooms
+
+		scratch.BeginSearch(GetArraySize(), request.tieBreakSalt);
+		scratch.Push(startIndex, -1, 0.f, GetHeuristicCost(startIndex, endIndex));
+
+		bool bFound = false;
+		while (!scratch.IsOpenEmpty())
+		{
+			//pick the record with the lowest f-cost
+			const int32_t current = scratch.PopLowest();
+			if (current == endIndex)
+			{
+				bFound = true;
+				break;
+			}
+
+			const float currentCost = scratch.GetCostSoFar(current);
+			const uint8_t neighborMask = GetNeighborMask(current);
+			for (int32_t direction{ 0 }; direction < static_cast<int32_t>(NeighborDirection::Count); ++direction)
+			{
+				if (!(neighborMask & (1 << direction)))
+					continue;
+
+				//the heuristic is consistent, a closed cell already has its cheapest cost
+				const int32_t neighbor = GetNeighbor(current, static_cast<NeighborDirection>(direction));
+				if (scratch.IsClosed(neighbor))
+					continue;
+
+				const float cellCost = GetCellCost(neighbor);
+				if (cellCost == BlockedCost)
+					continue;
+
+				//already queued with a cheaper cost? skip, otherwise move it up
+				const float stepCost = IsCorridor(neighbor) ? cellCost * corridorCostScale : cellCost;
+				const float costSoFar = currentCost + stepCost;
+				if (scratch.IsVisited(neighbor) && scratch.GetCostSoFar(neighbor) <= costSoFar)
+					continue;
+
+				scratch.Push(neighbor, current, costSoFar, costSoFar + GetHeuristicCost(neighbor, endIndex));
+			}
+		}
+
+		if (!bFound)
+			return false;
+
+		//walk back through the parents
+		for (int32_t cell = endIndex; cell != -1; cell = scratch.GetParent(cell))
+		{
+			outPath.push_back(cell);
+		}
+
+		std::reverse(outPath.begin(), outPath.end());
+		return true;
+	}
+
+	bool Grid::BidirectionalSearch(const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& forward, PathScratch& backward) const
+	{
+		outPath.clear();
+
+		const int32_t startIndex = request.start;
+		const int32_t endIndex = request.end;
+		if (startIndex == endIndex)
+		{
+			outPath.push_back(startIndex);
+			return true;
+		}
+		//the backward half would step off a blocked goal as if it could be entered
+		if (IsBlocked(endIndex))
+			return false;
+
+		//forward costs are from the start up to and with the cell, like AStarSearch. backward costs are from the cell to the goal,
+		//without the cell itself, so the two add up to a path cost wherever they meet
+		forward.BeginSearch(GetArraySize(), request.tieBreakSalt);
+		backward.BeginSearch(GetArraySize(), request.tieBreakSalt);
+		forward.Push(startIndex, -1, 0.f, GetHeuristicCost(startIndex, endIndex));
+		backward.Push(endIndex, -1, 0.f, GetHeuristicCost(endIndex, startIndex));
+
+		float bestCost = BlockedCost;
+		int32_t meeting = -1;
+		while (!forward.IsOpenEmpty() && !backward.IsOpenEmpty())
+		{
+			//both heuristics are consistent, so once either side can't find anything under the best meeting no path can
+			if (forward.GetLowestEstimate() >= bestCost || backward.GetLowestEstimate() >= bestCost)
+				break;
+
+			//grow the smaller frontier, forward on a tie, so the same query always expands the same cells
+			const bool bForward = forward.GetNumOpen() <= backward.GetNumOpen();
+			PathScratch& scratch = bForward ? forward : backward;
+			const PathScratch& other = bForward ? backward : forward;
+			const int32_t target = bForward ? endIndex : startIndex;
+
+			const int32_t current = scratch.PopLowest();
+			//backward, leaving a cell means having entered it. the start is the one blocked cell it may reach, and goes no further
+			const float currentCellCost = GetCellCost(current);
+			if (!bForward && currentCellCost == BlockedCost)
+				continue;
+
+			const float currentCost = scratch.GetCostSoFar(current);
+			const uint8_t neighborMask = GetNeighborMask(current);
+			for (int32_t direction{ 0 }; direction < static_cast<int32_t>(NeighborDirection::Count); ++direction)
+			{
+				if (!(neighborMask & (1 << direction)))
+					continue;
+
+				const int32_t neighbor = GetNeighbor(current, static_cast<NeighborDirection>(direction));
+				if (scratch.IsClosed(neighbor))
+					continue;
+				if (IsBlocked(neighbor) && (bForward || neighbor != startIndex))
+					continue;
+
+				const float costSoFar = currentCost + (bForward ? GetCellCost(neighbor) : currentCellCost);
+				if (scratch.IsVisited(neighbor) && scratch.GetCostSoFar(neighbor) <= costSoFar)
+					continue;
+
+				scratch.Push(neighbor, current, costSoFar, costSoFar + GetHeuristicCost(neighbor, target));
+
+				//strictly cheaper only, the first meeting of a cost is kept
+				if (other.IsVisited(neighbor) && costSoFar + other.GetCostSoFar(neighbor) < bestCost)
+				{
+					bestCost = costSoFar + other.GetCostSoFar(neighbor);
+					meeting = neighbor;
+				}
+			}
+		}
+
+		if (meeting == -1)
+			return false;
+
+		//start to the meeting cell through the forward parents, then on to the goal through the backward ones
+		for (int32_t cell = meeting; cell != -1; cell = forward.GetParent(cell))
+		{
+			outPath.push_back(cell);
+		}
+		std::reverse(outPath.begin(), outPath.end());
+		for (int32_t cell = backward.GetParent(meeting); cell != -1; cell = backward.GetParent(cell))
+		{
+			outPath.push_back(cell);
+		}
+		return true;
+	}
+
+	void Grid::MarkCorridor(const std::vector<int32_t>& path)
+	{
+		for (int32_t index : path)
+		{
+			MarkCorridorCell(index);
+		}
+	}
+
+	void Grid::MarkCorridorCell(int32_t index)
+	{
+		GridChunk& chunk = GetChunkForWrite(index);
+		const int32_t local = index & GridChunk::ChunkMask;
+		uint64_t& word = chunk.corridorBits[local >> 6];
+		const uint64_t bit = 1ULL << (local & 63);
+		if (word & bit)
+			return;
+
+		word |= bit;
+		++m_NumCorridorCells;
+		if (chunk.types[local] == static_cast<uint8_t>(CellType::Empty))
+			chunk.types[local] = static_cast<uint8_t>(CellType::Corridor);
+	}
+
+	size_t Grid::GetStorageBytes() const
+	{
+		size_t bytes = m_Chunks.capacity() * sizeof(GridChunk) + m_DirtyChunks.capacity() * sizeof(int32_t);
+		for (const GridChunk& chunk : m_Chunks)
+		{
+			bytes += chunk.costs.capacity() * sizeof(float);
+		}
+		return bytes;
+	}
+
+	float Grid::GetHeuristicCost(int32_t startIndex, int32_t endIndex) const
+	{
+		const int32_t columns = std::abs(startIndex % m_NrColumns - endIndex % m_NrColumns);
+		const int32_t rows = std::abs(startIndex / m_NrColumns - endIndex / m_NrColumns);
+		return static_cast<float>(columns + rows);
+	}
+
+	int32_t Grid::GetCellIndex(const Vec2& pos) const
+	{
+		int32_t widthIndex{ GetColumnIndex(pos.X) }; //Gets the width-> Column Index
+		int32_t heightIndex{ GetRowIndex(pos.Y) };
+
+		return heightIndex * m_NrColumns + widthIndex;
+	}
+
+	int32_t Grid::GetColumnIndex(const float xPosition) const
+	{
+		int32_t columnIndex{ static_cast<int32_t>(xPosition / m_Width) };
+		//the position might be outside of the grid, clamp it to the border cells
+		return std::min(std::max(columnIndex, 0), m_NrColumns - 1);
+	}
+
+	int32_t Grid::GetRowIndex(const float yPosition) const
+	{
+		int32_t rowIndex{ static_cast<int32_t>(yPosition / m_Depth) };
+		return std::min(std::max(rowIndex, 0), m_NrRow - 1);
+	}
+
+	bool Grid::CopyCellStates(const Grid& source)
+	{
+		if (source.m_NrRow != m_NrRow || source.m_NrColumns != m_NrColumns)
+			return false;
+
+		//only the chunks either grid has touched can differ
+		EmptyCells();
+		for (int32_t chunkIndex : source.m_DirtyChunks)
+		{
+			const GridChunk& sourceChunk = source.m_Chunks[chunkIndex];
+			GridChunk& chunk = GetChunkForWrite(chunkIndex << GridChunk::ChunkBits);
+			std::copy(std::begin(sourceChunk.types), std::end(sourceChunk.types), chunk.types);
+			std::copy(std::begin(sourceChunk.corridorBits), std::end(sourceChunk.corridorBits), chunk.corridorBits);
+		}
+		m_NumCorridorCells = source.m_NumCorridorCells;
+		return true;
+	}
+
+	bool Grid::CopyCellCosts(const Grid& source)
+	{
+		if (source.m_NrRow != m_NrRow || source.m_NrColumns != m_NrColumns)
+			return false;
+
+		//a chunk without a cost array on either side is all 1 on both. SetCellCost skips the cells that already match
+		for (size_t chunkIndex{ 0 }; chunkIndex < m_Chunks.size(); ++chunkIndex)
+		{
+			if (m_Chunks[chunkIndex].costs.empty() && source.m_Chunks[chunkIndex].costs.empty())
+				continue;
+
+			const int32_t begin = static_cast<int32_t>(chunkIndex) << GridChunk::ChunkBits;
+			const int32_t end = std::min(begin + GridChunk::ChunkSize, m_NumCells);
+			for (int32_t index = begin; index < end; ++index)
+			{
+				SetCellCost(index, source.GetCellCost(index));
+			}
+		}
+		return true;
+	}
+
+	void Grid::EmptyCells()
+	{
+		m_NumCorridorCells = 0;
+		for (int32_t chunkIndex : m_DirtyChunks)
+		{
+			GridChunk& chunk = m_Chunks[chunkIndex];
+			std::fill(std::begin(chunk.types), std::end(chunk.types), static_cast<uint8_t>(CellType::Empty));
+			std::fill(std::begin(chunk.corridorBits), std::end(chunk.corridorBits), 0ULL);
+			chunk.bDirty = false;
+		}
+		m_DirtyChunks.clear();
+	}
+}
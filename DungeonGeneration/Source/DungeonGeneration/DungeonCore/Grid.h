@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "PathScratch.h"
+#include "HierarchicalGraph.h"
+#include "Parallel.h"
+
+#include <limits>
+
+namespace DungeonCore
+{
+	enum class CellType : uint8_t
+	{
+		Room,
+		Corridor,
+		Empty
+	};
+
+	//the four neighbors of a cell, in the order the searches visit them. bit d of Grid::GetNeighborMask is direction d
+	enum class NeighborDirection : uint8_t
+	{
+		Right,
+		Up,
+		Left,
+		Down,
+		Count
+	};
+
+	//one corridor to route, as cell indices
+	struct PathRequest
+	{
+		int32_t start = -1;
+		int32_t end = -1;
+		uint32_t tieBreakSalt = 0; //picks between equally good paths, see PathScratch::BeginSearch
+	};
+
+	//One cell's state plus its geometry, worked out from the index when asked for. The grid only stores the state, see GridChunk
+	struct Cell
+	{
+		Vec2 bottomLeft;
+		Vec2 center;
+		float width = 0.f;
+		float depth = 0.f;
+		CellType type = CellType::Empty;
+		float cost = 1.f;
+		bool isEmpty = true;
+		int32_t index = -1;
+		bool isCorridor = false;
+	};
+
+	//ChunkSize consecutive cells of the grid, structure of arrays. ChunkSize is a multiple of 64,
+	//so the corridor words of chunk c are words c * ChunkSize / 64 onwards of the grid wide bitset
+	struct GridChunk
+	{
+		static constexpr int32_t ChunkBits = 12;
+		static constexpr int32_t ChunkSize = 1 << ChunkBits;
+		static constexpr int32_t ChunkMask = ChunkSize - 1;
+
+		uint8_t types[ChunkSize];                //CellType, a room stays Room when a corridor crosses it
+		uint64_t corridorBits[ChunkSize / 64];   //cells any corridor runs through, rooms included
+		std::vector<float> costs;                //empty while every cell of the chunk costs 1
+		bool bDirty = false;                     //has a room or corridor since the last EmptyCells
+	};
+
+	//Engine-free grid: cell layout, occupancy and corridor search. AC_Grid owns one and only adds meshes on top.
+	class Grid
+	{
+	public:
+		//cells are indexed with int32_t, rows * columns can't be more
+		static constexpr int64_t MaxCells = std::numeric_limits<int32_t>::max();
+		//a cell with this cost is a wall, no search steps onto it
+		static constexpr float BlockedCost = std::numeric_limits<float>::infinity();
+
+		Grid(int32_t nrRows = 100, int32_t nrColumns = 100, float width = 100.f, float depth = 100.f);
+
+		//rebuilds the grid with new dimensions, every cell empty again. false, and a grid without cells,
+		//if a side is negative or rows * columns is more than MaxCells
+		bool Resize(int32_t nrRows, int32_t nrColumns, float width, float depth);
+
+		//Returns the index of a cell given its position
+		int32_t GetCellIndex(const Vec2& pos) const;
+		//center of a cell from its index alone, without touching the cell
+		Vec2 GetCellCenter(int32_t index) const
+		{
+			return Vec2((index % m_NrColumns) * m_Width + m_Width / 2.0f, (index / m_NrColumns) * m_Depth + m_Depth / 2.0f);
+		}
+		Vec2 GetCellBottomLeft(int32_t index) const
+		{
+			return Vec2((index % m_NrColumns) * m_Width, (index / m_NrColumns) * m_Depth);
+		}
+		//copy of the cell's state and geometry, for drawing and tools. the searches use the accessors below
+		Cell GetCell(int32_t index) const;
+		//number of cells
+		int32_t GetArraySize() const { return m_NumCells; }
+
+		CellType GetCellType(int32_t index) const { return static_cast<CellType>(GetChunk(index).types[index & GridChunk::ChunkMask]); }
+		bool IsEmpty(int32_t index) const { return GetCellType(index) != CellType::Room; }
+		bool IsCorridor(int32_t index) const
+		{
+			const int32_t local = index & GridChunk::ChunkMask;
+			return (GetChunk(index).corridorBits[local >> 6] >> (local & 63)) & 1;
+		}
+		float GetCellCost(int32_t index) const
+		{
+			const GridChunk& chunk = GetChunk(index);
+			return chunk.costs.empty() ? 1.f : chunk.costs[index & GridChunk::ChunkMask];
+		}
+		bool IsBlocked(int32_t index) const { return GetCellCost(index) == BlockedCost; }
+		//word of the grid wide corridor bitset, cell i is bit i & 63 of word i >> 6
+		uint64_t GetCorridorWord(int32_t word) const { return m_Chunks[word >> (GridChunk::ChunkBits - 6)].corridorBits[word & (GridChunk::ChunkSize / 64 - 1)]; }
+		//chunks written to since the last EmptyCells, the only ones with rooms or corridors in them
+		const std::vector<int32_t>& GetDirtyChunks() const { return m_DirtyChunks; }
+
+		//claims a cell for a room
+		void SetRoom(int32_t index);
+		//cost of stepping onto the cell, kept through EmptyCells. below 1 the heuristic overestimates, like corridorCostScale.
+		//BlockedCost walls the cell off
+		void SetCellCost(int32_t index, float cost);
+		//true while every step of a search costs 1: no cell costs anything but 1 or BlockedCost,
+		//and corridors are either not discounted or there are none yet
+		bool HasUniformCost(float corridorCostScale) const { return m_NumWeightedCells == 0 && (corridorCostScale == 1.f || m_NumCorridorCells == 0); }
+		//rows of the blocked cells of a column and columns of the blocked cells of a row, sorted. empty when there are none
+		const std::vector<int32_t>& GetBlockedRows(int32_t column) const;
+		const std::vector<int32_t>& GetBlockedColumns(int32_t row) const;
+		//sorted columns holding at least one blocked cell
+		const std::vector<int32_t>& GetColumnsWithBlockedCells() const { return m_ColumnsWithBlockedCells; }
+
+		//adjacency is implicit: the neighbors of a cell come from its row and column, nothing is stored per edge.
+		//bit d is set if the neighbor in NeighborDirection d is on the grid
+		uint8_t GetNeighborMask(int32_t index) const
+		{
+			const int32_t column = index % m_NrColumns;
+			const int32_t row = index / m_NrColumns;
+			return static_cast<uint8_t>((column + 1 < m_NrColumns ? 1 : 0) | (row + 1 < m_NrRow ? 2 : 0) | (column > 0 ? 4 : 0) | (row > 0 ? 8 : 0));
+		}
+		//the neighbor in a direction, only valid when its bit is in GetNeighborMask
+		int32_t GetNeighbor(int32_t index, NeighborDirection direction) const
+		{
+			const int32_t offsets[] = { 1, m_NrColumns, -1, -m_NrColumns };
+			return index + offsets[static_cast<size_t>(direction)];
+		}
+
+		int32_t GetNrRows() const { return m_NrRow; }
+		int32_t GetNrColumns() const { return m_NrColumns; }
+		float GetCellWidth() const { return m_Width; }
+		float GetCellDepth() const { return m_Depth; }
+
+		//resets occupancy and corridor flags, only in the chunks that have any. keeps the costs
+		void EmptyCells();
+		//takes over the occupancy and corridor flags of a grid with the same rows and columns, false if they differ
+		bool CopyCellStates(const Grid& source);
+		//takes over the cost of every cell of a grid with the same rows and columns through SetCellCost, false if they differ
+		bool CopyCellCosts(const Grid& source);
+
+		//finds a shortest path between two cells and writes it start to end into outPath. returns false if none exists
+		bool AStarPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath);
+		//same, with caller owned search state
+		bool AStarPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch) const;
+		//a path as short as AStarPath's through jump point search, see JumpPointSearch.h. AStarPath when HasUniformCost(1) is false
+		bool JumpPointPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath);
+		bool JumpPointPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch) const;
+		//a path through the abstract graph of HierarchicalGraph, refined inside the clusters it crosses. not always as short as AStarPath's.
+		//brings the graph up to date first
+		bool HierarchicalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath);
+		//same, with caller owned search state. AStarPath when the graph isn't current, see UpdateHierarchy
+		bool HierarchicalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch,
+			HierarchicalScratch& hierarchicalScratch) const;
+		//builds the abstract graph the first time, afterwards only rebuilds the clusters whose cell costs changed. FindPaths calls it when it needs it
+		void UpdateHierarchy() { m_Hierarchy.Update(*this); }
+		const HierarchicalGraph& GetHierarchy() const { return m_Hierarchy; }
+		//A* from both ends at once, meeting in the middle. as short as AStarPath's, usually with fewer expansions on long paths through clutter.
+		//ties go the same way on every run. the expansions are forward.GetNumExpanded() + backward.GetNumExpanded()
+		bool BidirectionalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath);
+		bool BidirectionalPath(int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& forward, PathScratch& backward) const;
+		//the search FindPaths and FindPath route with. JumpPoint only runs while HasUniformCost holds for their scale,
+		//Hierarchical and Bidirectional while the scale is 1 or there are no corridors yet. AStar runs otherwise
+		void SetPathSearch(PathSearch search) { m_PathSearch = search; }
+		PathSearch GetPathSearch() const { return m_PathSearch; }
+		//routes every request in order and marks each path as corridor before routing the next one. outPaths[i] belongs to requests[i].
+		//stepping onto a corridor costs corridorCostScale, below 1 later paths merge into the hallways already carved.
+		//returns false if any request had no path, its entry is left empty.
+		//with an executor and a scale of 1 the searches don't depend on each other: they run in parallel, one scratch per worker,
+		//and the corridors are marked afterwards in request order, so the result is the same as the serial one
+		bool FindPaths(const std::vector<PathRequest>& requests, float corridorCostScale, std::vector<std::vector<int32_t>>& outPaths,
+			ParallelExecutor* pExecutor = nullptr);
+		//one request of the serial FindPaths: routes it and marks it as corridor. outPath is left empty if there is no path
+		bool FindPath(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath);
+		//marks every cell of the path as corridor
+		void MarkCorridor(const std::vector<int32_t>& path);
+		void MarkCorridorCell(int32_t index);
+		//cells marked as corridor since the last EmptyCells
+		int32_t GetNumCorridorCells() const { return m_NumCorridorCells; }
+
+		//bytes held by the cell state, capacity included
+		size_t GetStorageBytes() const;
+
+		//manhattan distance in cells, never more than the real cost since every step costs at least 1 (corridors aside, see FindPaths)
+		float GetHeuristicCost(int32_t startIndex, int32_t endIndex) const;
+
+	private:
+		int32_t m_NrRow;
+		int32_t m_NrColumns;
+
+		float m_Width;
+		float m_Depth;
+		int32_t m_NumCells = 0;
+
+		std::vector<GridChunk> m_Chunks;
+		std::vector<int32_t> m_DirtyChunks;
+
+		//the search state of one thread, whatever m_PathSearch is
+		struct SearchScratch
+		{
+			PathScratch path;
+			PathScratch backward; //the half of the bidirectional search that starts at the goal
+			HierarchicalScratch hierarchical;
+		};
+		SearchScratch m_Scratch;
+		std::vector<SearchScratch> m_WorkerScratch;
+		HierarchicalGraph m_Hierarchy;
+		std::vector<uint8_t> m_PathFound;
+		int32_t m_NumCorridorCells = 0;
+		PathSearch m_PathSearch = PathSearch::AStar;
+
+		//finite costs other than 1, and the blocked cells by column and by row. the lists stay empty until a cell is blocked
+		int32_t m_NumWeightedCells = 0;
+		std::vector<std::vector<int32_t>> m_BlockedRowsByColumn;
+		std::vector<std::vector<int32_t>> m_BlockedColumnsByRow;
+		std::vector<int32_t> m_ColumnsWithBlockedCells;
+
+		GridChunk& GetChunk(int32_t index) { return m_Chunks[index >> GridChunk::ChunkBits]; }
+		const GridChunk& GetChunk(int32_t index) const { return m_Chunks[index >> GridChunk::ChunkBits]; }
+		//the chunk of the cell, flagged so the next EmptyCells resets it
+		GridChunk& GetChunkForWrite(int32_t index);
+		//runs m_PathSearch, or AStarSearch when it can't handle the costs
+		bool Search(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath, SearchScratch& scratch) const;
+		bool AStarSearch(const PathRequest& request, float corridorCostScale, std::vector<int32_t>& outPath, PathScratch& scratch) const;
+		bool BidirectionalSearch(const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& forward, PathScratch& backward) const;
+		void AddBlockedCell(int32_t index);
+		void RemoveBlockedCell(int32_t index);
+
+		//finds the index of the row given yPos
+		int32_t GetRowIndex(const float yPosition) const;
+		//finds the index of the column given xPos
+		int32_t GetColumnIndex(const float xPosition) const;
+	};
+}
@@ -0,0 +1,497 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HierarchicalGraph.h"
+#include "Grid.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace DungeonCore
+{
+	constexpr int32_t HierarchicalGraph::ClusterSize;
+
+	namespace
+	{
+		constexpr float Unreachable = std::numeric_limits<float>::infinity();
+
+		//an open stretch of border this long gets an entrance at both ends, a shorter one a single entrance in the middle
+		constexpr int32_t LongBorderRun = 6;
+	}
+
+	void HierarchicalGraph::Reset(int32_t nrRows, int32_t nrColumns)
+	{
+		m_NrRow = nrRows;
+		m_NrColumns = nrColumns;
+		m_ClusterColumns = (nrColumns + ClusterSize - 1) / ClusterSize;
+		m_ClusterRows = (nrRows + ClusterSize - 1) / ClusterSize;
+
+		m_Clusters.clear();
+		m_DirtyClusters.clear();
+		m_NodeOffsets.clear();
+		m_NodeClusters.clear();
+		m_NumClusterBuilds = 0;
+	}
+
+	void HierarchicalGraph::Invalidate(int32_t index)
+	{
+		if (m_Clusters.empty())
+			return;
+
+		Cluster& cluster = m_Clusters[GetCluster(index)];
+		if (cluster.bDirty)
+			return;
+
+		cluster.bDirty = true;
+		m_DirtyClusters.push_back(GetCluster(index));
+	}
+
+	void HierarchicalGraph::Update(const Grid& grid)
+	{
+		m_Rebuild.clear();
+		if (m_Clusters.empty())
+		{
+			m_Clusters.resize(static_cast<size_t>(m_ClusterColumns) * m_ClusterRows);
+			for (int32_t cluster{ 0 }; cluster < GetNumClusters(); ++cluster)
+			{
+				m_Rebuild.push_back(cluster);
+			}
+		}
+		else
+		{
+			if (m_DirtyClusters.empty())
+				return;
+
+			//a border belongs to the clusters on both sides, so the neighbors of a changed cluster may get other entrances too
+			m_Rebuild = m_DirtyClusters;
+			for (int32_t cluster : m_DirtyClusters)
+			{
+				const int32_t column = cluster % m_ClusterColumns;
+				const int32_t row = cluster / m_ClusterColumns;
+				const int32_t neighbors[] = {
+					column + 1 < m_ClusterColumns ? cluster + 1 : -1,
+					row + 1 < m_ClusterRows ? cluster + m_ClusterColumns : -1,
+					column > 0 ? cluster - 1 : -1,
+					row > 0 ? cluster - m_ClusterColumns : -1 };
+				for (int32_t neighbor : neighbors)
+				{
+					if (neighbor == -1 || m_Clusters[neighbor].bDirty)
+						continue;
+					m_Clusters[neighbor].bDirty = true;
+					m_Rebuild.push_back(neighbor);
+				}
+			}
+		}
+
+		for (int32_t cluster : m_Rebuild)
+		{
+			BuildCluster(grid, cluster);
+		}
+		m_DirtyClusters.clear();
+
+		//the node numbering follows the cluster order, a rebuilt cluster with more or fewer entrances shifts the ones after it
+		const int32_t numClusters = GetNumClusters();
+		m_NodeOffsets.resize(numClusters + 1);
+		m_NodeOffsets[0] = 0;
+		for (int32_t cluster{ 0 }; cluster < numClusters; ++cluster)
+		{
+			m_NodeOffsets[cluster + 1] = m_NodeOffsets[cluster] + static_cast<int32_t>(m_Clusters[cluster].nodeCells.size());
+		}
+		m_NodeClusters.resize(m_NodeOffsets.back());
+		for (int32_t cluster{ 0 }; cluster < numClusters; ++cluster)
+		{
+			std::fill(m_NodeClusters.begin() + m_NodeOffsets[cluster], m_NodeClusters.begin() + m_NodeOffsets[cluster + 1], cluster);
+		}
+	}
+
+	int32_t HierarchicalGraph::GetCluster(int32_t index) const
+	{
+		return (index / m_NrColumns / ClusterSize) * m_ClusterColumns + (index % m_NrColumns) / ClusterSize;
+	}
+
+	HierarchicalGraph::ClusterBounds HierarchicalGraph::GetBounds(int32_t cluster) const
+	{
+		ClusterBounds bounds;
+		bounds.beginColumn = (cluster % m_ClusterColumns) * ClusterSize;
+		bounds.endColumn = std::min(bounds.beginColumn + ClusterSize, m_NrColumns);
+		bounds.beginRow = (cluster / m_ClusterColumns) * ClusterSize;
+		bounds.endRow = std::min(bounds.beginRow + ClusterSize, m_NrRow);
+		return bounds;
+	}
+
+	void HierarchicalGraph::BuildCluster(const Grid& grid, int32_t clusterIndex)
+	{
+		Cluster& cluster = m_Clusters[clusterIndex];
+		cluster.nodeCells.clear();
+		cluster.borderMasks.clear();
+		cluster.bDirty = false;
+		++m_NumClusterBuilds;
+
+		const ClusterBounds bounds = GetBounds(clusterIndex);
+		cluster.bUniform = true;
+		for (int32_t row = bounds.beginRow; row < bounds.endRow && cluster.bUniform; ++row)
+		{
+			for (int32_t column = bounds.beginColumn; column < bounds.endColumn; ++column)
+			{
+				if (grid.GetCellCost(row * m_NrColumns + column) != 1.f)
+				{
+					cluster.bUniform = false;
+					break;
+				}
+			}
+		}
+
+		for (int32_t direction{ 0 }; direction < static_cast<int32_t>(NeighborDirection::Count); ++direction)
+		{
+			AddEntrances(grid, clusterIndex, direction);
+		}
+
+		//every entrance to every other one, without leaving the cluster
+		const size_t numNodes = cluster.nodeCells.size();
+		cluster.distances.assign(numNodes * numNodes, Unreachable);
+		for (size_t i{ 0 }; i < numNodes; ++i)
+		{
+			if (!cluster.bUniform)
+				SearchBounds(grid, bounds, cluster.nodeCells[i], -1, false, m_BuildScratch);
+
+			for (size_t j{ 0 }; j < numNodes; ++j)
+			{
+				const int32_t cell = cluster.nodeCells[j];
+				const int32_t local = bounds.ToLocal(cell, m_NrColumns);
+				if (cluster.bUniform)
+					cluster.distances[i * numNodes + j] = grid.GetHeuristicCost(cluster.nodeCells[i], cell);
+				else if (m_BuildScratch.IsClosed(local))
+					cluster.distances[i * numNodes + j] = m_BuildScratch.GetCostSoFar(local);
+			}
+		}
+	}
+
+	void HierarchicalGraph::AddEntrances(const Grid& grid, int32_t clusterIndex, int32_t direction)
+	{
+		const ClusterBounds bounds = GetBounds(clusterIndex);
+
+		//the border cells of this cluster, the step along the border and the step over it
+		int32_t first = 0;
+		int32_t along = 0;
+		int32_t across = 0;
+		int32_t length = 0;
+		switch (static_cast<NeighborDirection>(direction))
+		{
+		case NeighborDirection::Right:
+			if (bounds.endColumn >= m_NrColumns)
+				return;
+			first = bounds.beginRow * m_NrColumns + bounds.endColumn - 1;
+			along = m_NrColumns;
+			across = 1;
+			length = bounds.endRow - bounds.beginRow;
+			break;
+		case NeighborDirection::Up:
+			if (bounds.endRow >= m_NrRow)
+				return;
+			first = (bounds.endRow - 1) * m_NrColumns + bounds.beginColumn;
+			along = 1;
+			across = m_NrColumns;
+			length = bounds.endColumn - bounds.beginColumn;
+			break;
+		case NeighborDirection::Left:
+			if (bounds.beginColumn == 0)
+				return;
+			first = bounds.beginRow * m_NrColumns + bounds.beginColumn;
+			along = m_NrColumns;
+			across = -1;
+			length = bounds.endRow - bounds.beginRow;
+			break;
+		default:
+			if (bounds.beginRow == 0)
+				return;
+			first = bounds.beginRow * m_NrColumns + bounds.beginColumn;
+			along = 1;
+			across = -m_NrColumns;
+			length = bounds.endColumn - bounds.beginColumn;
+			break;
+		}
+
+		//both clusters walk their shared border in the same order, so they put the entrances on the same pairs of cells
+		Cluster& cluster = m_Clusters[clusterIndex];
+		const auto addEntrance = [this, &cluster, clusterIndex, direction](int32_t cell)
+		{
+			int32_t node = FindNode(clusterIndex, cell);
+			if (node == -1)
+			{
+				node = static_cast<int32_t>(cluster.nodeCells.size());
+				cluster.nodeCells.push_back(cell);
+				cluster.borderMasks.push_back(0);
+			}
+			cluster.borderMasks[node] |= static_cast<uint8_t>(1 << direction);
+		};
+
+		int32_t runStart = -1;
+		for (int32_t i{ 0 }; i <= length; ++i)
+		{
+			const int32_t cell = first + i * along;
+			const bool bOpen = i < length && !grid.IsBlocked(cell) && !grid.IsBlocked(cell + across);
+			if (bOpen)
+			{
+				if (runStart == -1)
+					runStart = i;
+				continue;
+			}
+			if (runStart == -1)
+				continue;
+
+			if (i - runStart < LongBorderRun)
+			{
+				addEntrance(first + (runStart + (i - runStart) / 2) * along);
+			}
+			else
+			{
+				addEntrance(first + runStart * along);
+				addEntrance(first + (i - 1) * along);
+			}
+			runStart = -1;
+		}
+	}
+
+	int32_t HierarchicalGraph::FindNode(int32_t cluster, int32_t cell) const
+	{
+		const std::vector<int32_t>& cells = m_Clusters[cluster].nodeCells;
+		const auto it = std::find(cells.begin(), cells.end(), cell);
+		return it == cells.end() ? -1 : static_cast<int32_t>(it - cells.begin());
+	}
+
+	bool HierarchicalGraph::SearchBounds(const Grid& grid, const ClusterBounds& bounds, int32_t source, int32_t goal, bool bToSource, PathScratch& scratch) const
+	{
+		const int32_t width = bounds.endColumn - bounds.beginColumn;
+		const int32_t height = bounds.endRow - bounds.beginRow;
+		const int32_t localGoal = goal == -1 ? -1 : bounds.ToLocal(goal, m_NrColumns);
+		const auto getHeuristic = [&](int32_t local)
+		{
+			return goal == -1 ? 0.f : grid.GetHeuristicCost(bounds.ToCell(local, m_NrColumns), goal);
+		};
+
+		scratch.BeginSearch(ClusterSize * ClusterSize);
+		const int32_t localSource = bounds.ToLocal(source, m_NrColumns);
+		scratch.Push(localSource, -1, 0.f, getHeuristic(localSource));
+		while (!scratch.IsOpenEmpty())
+		{
+			const int32_t current = scratch.PopLowest();
+			if (current == localGoal)
+				return true;
+
+			//the neighbors in NeighborDirection order, as long as they are inside the bounds
+			const int32_t column = current % ClusterSize;
+			const int32_t row = current / ClusterSize;
+			const int32_t neighbors[] = {
+				column + 1 < width ? current + 1 : -1,
+				row + 1 < height ? current + ClusterSize : -1,
+				column > 0 ? current - 1 : -1,
+				row > 0 ? current - ClusterSize : -1 };
+
+			const float currentCost = scratch.GetCostSoFar(current);
+			for (int32_t neighbor : neighbors)
+			{
+				if (neighbor == -1 || scratch.IsClosed(neighbor))
+					continue;
+
+				const int32_t neighborCell = bounds.ToCell(neighbor, m_NrColumns);
+				if (grid.IsBlocked(neighborCell))
+					continue;
+
+				//towards the source the step goes from the neighbor onto the current cell
+				const float costSoFar = currentCost + grid.GetCellCost(bToSource ? bounds.ToCell(current, m_NrColumns) : neighborCell);
+				if (scratch.IsVisited(neighbor) && scratch.GetCostSoFar(neighbor) <= costSoFar)
+					continue;
+
+				scratch.Push(neighbor, current, costSoFar, costSoFar + getHeuristic(neighbor));
+			}
+		}
+		return goal == -1;
+	}
+
+	bool HierarchicalGraph::RefineInCluster(const Grid& grid, int32_t clusterIndex, int32_t start, int32_t goal, std::vector<int32_t>& outPath,
+		PathScratch& scratch, HierarchicalScratch& hierarchicalScratch) const
+	{
+		if (start == goal)
+			return true;
+
+		//nothing in the way: along the row, then along the column
+		if (m_Clusters[clusterIndex].bUniform)
+		{
+			const int32_t stepX = goal % m_NrColumns > start % m_NrColumns ? 1 : -1;
+			const int32_t stepY = goal / m_NrColumns > start / m_NrColumns ? m_NrColumns : -m_NrColumns;
+			int32_t cell = start;
+			while (cell % m_NrColumns != goal % m_NrColumns)
+			{
+				cell += stepX;
+				outPath.push_back(cell);
+			}
+			while (cell != goal)
+			{
+				cell += stepY;
+				outPath.push_back(cell);
+			}
+			return true;
+		}
+
+		const ClusterBounds bounds = GetBounds(clusterIndex);
+		const bool bFound = SearchBounds(grid, bounds, start, goal, false, scratch);
+		hierarchicalScratch.numExpanded += scratch.GetNumExpanded();
+		if (!bFound)
+			return false;
+
+		std::vector<int32_t>& segment = hierarchicalScratch.segment;
+		segment.clear();
+		const int32_t localStart = bounds.ToLocal(start, m_NrColumns);
+		for (int32_t local = bounds.ToLocal(goal, m_NrColumns); local != localStart; local = scratch.GetParent(local))
+		{
+			segment.push_back(bounds.ToCell(local, m_NrColumns));
+		}
+		outPath.insert(outPath.end(), segment.rbegin(), segment.rend());
+		return true;
+	}
+
+	bool HierarchicalGraph::FindPath(const Grid& grid, const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& scratch,
+		HierarchicalScratch& hierarchicalScratch) const
+	{
+		outPath.clear();
+		hierarchicalScratch.numExpanded = 0;
+
+		const int32_t startIndex = request.start;
+		const int32_t endIndex = request.end;
+		const int32_t startCluster = GetCluster(startIndex);
+		const int32_t goalCluster = GetCluster(endIndex);
+		//a blocked start can still be left, but no entrance leads out of it across a border
+		if (startCluster == goalCluster || grid.IsBlocked(startIndex))
+		{
+			const bool bFound = grid.AStarPath(startIndex, endIndex, outPath, scratch);
+			hierarchicalScratch.numExpanded = scratch.GetNumExpanded();
+			return bFound;
+		}
+		if (grid.IsBlocked(endIndex))
+			return false;
+
+		//the start and the goal join the graph through the entrances of their own cluster
+		const auto linkToEntrances = [&](int32_t cell, int32_t clusterIndex, bool bToCell, std::vector<float>& outCosts)
+		{
+			const Cluster& cluster = m_Clusters[clusterIndex];
+			outCosts.assign(cluster.nodeCells.size(), Unreachable);
+			const ClusterBounds bounds = GetBounds(clusterIndex);
+			if (!cluster.bUniform)
+			{
+				SearchBounds(grid, bounds, cell, -1, bToCell, scratch);
+				hierarchicalScratch.numExpanded += scratch.GetNumExpanded();
+			}
+			for (size_t i{ 0 }; i < cluster.nodeCells.size(); ++i)
+			{
+				const int32_t local = bounds.ToLocal(cluster.nodeCells[i], m_NrColumns);
+				if (cluster.bUniform)
+					outCosts[i] = grid.GetHeuristicCost(cell, cluster.nodeCells[i]);
+				else if (scratch.IsClosed(local))
+					outCosts[i] = scratch.GetCostSoFar(local);
+			}
+		};
+		linkToEntrances(startIndex, startCluster, false, hierarchicalScratch.startCosts);
+		linkToEntrances(endIndex, goalCluster, true, hierarchicalScratch.goalCosts);
+
+		//A* over the abstract graph, the start and the goal are the two nodes after the entrances
+		const int32_t numNodes = GetNumNodes();
+		const int32_t startNode = numNodes;
+		const int32_t goalNode = numNodes + 1;
+		const auto getNodeCell = [&](int32_t node)
+		{
+			if (node >= numNodes)
+				return node == startNode ? startIndex : endIndex;
+			const int32_t cluster = m_NodeClusters[node];
+			return m_Clusters[cluster].nodeCells[node - m_NodeOffsets[cluster]];
+		};
+
+		scratch.BeginSearch(numNodes + 2, request.tieBreakSalt);
+		scratch.Push(startNode, -1, 0.f, grid.GetHeuristicCost(startIndex, endIndex));
+		bool bFound = false;
+		while (!scratch.IsOpenEmpty())
+		{
+			const int32_t current = scratch.PopLowest();
+			if (current == goalNode)
+			{
+				bFound = true;
+				break;
+			}
+
+			const float currentCost = scratch.GetCostSoFar(current);
+			const auto relax = [&](int32_t node, float edgeCost)
+			{
+				const float costSoFar = currentCost + edgeCost;
+				if (edgeCost == Unreachable || scratch.IsClosed(node) || (scratch.IsVisited(node) && scratch.GetCostSoFar(node) <= costSoFar))
+					return;
+				scratch.Push(node, current, costSoFar, costSoFar + grid.GetHeuristicCost(getNodeCell(node), endIndex));
+			};
+
+			if (current == startNode)
+			{
+				for (size_t i{ 0 }; i < hierarchicalScratch.startCosts.size(); ++i)
+				{
+					relax(m_NodeOffsets[startCluster] + static_cast<int32_t>(i), hierarchicalScratch.startCosts[i]);
+				}
+				continue;
+			}
+
+			const int32_t clusterIndex = m_NodeClusters[current];
+			const Cluster& cluster = m_Clusters[clusterIndex];
+			const int32_t offset = m_NodeOffsets[clusterIndex];
+			const int32_t local = current - offset;
+			const int32_t numClusterNodes = static_cast<int32_t>(cluster.nodeCells.size());
+			for (int32_t j{ 0 }; j < numClusterNodes; ++j)
+			{
+				if (j != local)
+					relax(offset + j, cluster.distances[local * numClusterNodes + j]);
+			}
+
+			//one step over the border into the next cluster
+			const int32_t cell = cluster.nodeCells[local];
+			for (int32_t direction{ 0 }; direction < static_cast<int32_t>(NeighborDirection::Count); ++direction)
+			{
+				if (!(cluster.borderMasks[local] & (1 << direction)))
+					continue;
+
+				const int32_t neighbor = grid.GetNeighbor(cell, static_cast<NeighborDirection>(direction));
+				const int32_t neighborCluster = GetCluster(neighbor);
+				relax(m_NodeOffsets[neighborCluster] + FindNode(neighborCluster, neighbor), grid.GetCellCost(neighbor));
+			}
+
+			if (clusterIndex == goalCluster)
+				relax(goalNode, hierarchicalScratch.goalCosts[local]);
+		}
+		hierarchicalScratch.numExpanded += scratch.GetNumExpanded();
+		if (!bFound)
+			return false;
+
+		//the refinement searches reuse the scratch, keep the abstract path first
+		std::vector<int32_t>& nodePath = hierarchicalScratch.nodePath;
+		nodePath.clear();
+		for (int32_t node = goalNode; node != -1; node = scratch.GetParent(node))
+		{
+			nodePath.push_back(node);
+		}
+
+		//turn each abstract edge back into cells: a step over a border, or a path inside one cluster
+		outPath.push_back(startIndex);
+		for (size_t i = nodePath.size() - 1; i > 0; --i)
+		{
+			const int32_t from = nodePath[i];
+			const int32_t to = nodePath[i - 1];
+			int32_t refineCluster = -1;
+			if (from == startNode)
+				refineCluster = startCluster;
+			else if (to == goalNode)
+				refineCluster = goalCluster;
+			else if (m_NodeClusters[from] == m_NodeClusters[to])
+				refineCluster = m_NodeClusters[from];
+
+			if (refineCluster == -1)
+				outPath.push_back(getNodeCell(to));
+			else if (!RefineInCluster(grid, refineCluster, getNodeCell(from), getNodeCell(to), outPath, scratch, hierarchicalScratch))
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "PathScratch.h"
+
+namespace DungeonCore
+{
+	class Grid;
+	struct PathRequest;
+
+	//per query state of HierarchicalGraph::FindPath, reused between queries. the searches themselves run in a PathScratch
+	struct HierarchicalScratch
+	{
+		std::vector<float> startCosts;   //from the start to each entrance of its cluster
+		std::vector<float> goalCosts;    //from each entrance of the goal's cluster to the goal
+		std::vector<int32_t> nodePath;   //abstract nodes, goal to start
+		std::vector<int32_t> segment;    //one refined piece of the path
+		int32_t numExpanded = 0;         //cells and abstract nodes closed by the last query
+	};
+
+	//HPA*: the grid cut into ClusterSize x ClusterSize clusters. Wherever two clusters touch through open cells there are entrances,
+	//one or two per open stretch of their border, and each entrance is a node of an abstract graph. Nodes across a border are one step apart,
+	//nodes in the same cluster are linked with the cost of the cheapest path between them inside the cluster.
+	//A query adds the start and goal to the graph, searches it, and only then searches cells, inside the clusters the abstract path went through.
+	//The paths are not always the shortest: a few percent longer than A* on cluttered grids, about a tenth on the default dungeons. Rooms don't change what a step costs, so placing them leaves the graph alone;
+	//a cell cost change only rebuilds its own cluster and the four around it, whose shared borders may have changed
+	class HierarchicalGraph
+	{
+	public:
+		static constexpr int32_t ClusterSize = 16;
+
+		//drops the graph, the next Update builds it for a grid of this size
+		void Reset(int32_t nrRows, int32_t nrColumns);
+		//the cost of the cell changed, its cluster is rebuilt by the next Update. does nothing before the graph is built
+		void Invalidate(int32_t index);
+		//builds the graph the first time, afterwards only the clusters invalidated since and their neighbors
+		void Update(const Grid& grid);
+		//built and no cluster waiting for Update
+		bool IsCurrent() const { return !m_Clusters.empty() && m_DirtyClusters.empty(); }
+
+		//writes a path from request.start to request.end into outPath, false if there is none. the graph has to be current.
+		//start and goal in one cluster are searched with plain A*, the cheapest path between them may well leave the cluster. so is a blocked start
+		bool FindPath(const Grid& grid, const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& scratch,
+			HierarchicalScratch& hierarchicalScratch) const;
+
+		int32_t GetNumClusters() const { return static_cast<int32_t>(m_Clusters.size()); }
+		int32_t GetNumNodes() const { return m_NodeOffsets.empty() ? 0 : m_NodeOffsets.back(); }
+		//clusters built since Reset, the first Update counts all of them
+		int32_t GetNumClusterBuilds() const { return m_NumClusterBuilds; }
+
+	private:
+		struct Cluster
+		{
+			std::vector<int32_t> nodeCells;    //the cells of its entrances
+			std::vector<uint8_t> borderMasks;  //per entrance, bit d if the neighbor in NeighborDirection d is an entrance of the next cluster
+			std::vector<float> distances;      //distances[i * n + j], the cost from entrance i to entrance j inside the cluster
+			bool bUniform = true;              //every cell costs 1, distances are manhattan and paths a straight corner
+			bool bDirty = false;
+		};
+
+		//the cells of a cluster, end exclusive
+		struct ClusterBounds
+		{
+			int32_t beginColumn = 0;
+			int32_t endColumn = 0;
+			int32_t beginRow = 0;
+			int32_t endRow = 0;
+
+			//the searches inside a cluster number its cells row by row, ClusterSize per row, so their scratch never grows past ClusterSize^2
+			int32_t ToLocal(int32_t cell, int32_t nrColumns) const { return (cell / nrColumns - beginRow) * ClusterSize + cell % nrColumns - beginColumn; }
+			int32_t ToCell(int32_t local, int32_t nrColumns) const { return (beginRow + local / ClusterSize) * nrColumns + beginColumn + local % ClusterSize; }
+		};
+
+		int32_t m_NrRow = 0;
+		int32_t m_NrColumns = 0;
+		int32_t m_ClusterColumns = 0;
+		int32_t m_ClusterRows = 0;
+
+		std::vector<Cluster> m_Clusters;
+		std::vector<int32_t> m_DirtyClusters;
+		std::vector<int32_t> m_NodeOffsets;   //node i of cluster c is abstract node m_NodeOffsets[c] + i, numClusters + 1 entries
+		std::vector<int32_t> m_NodeClusters;  //cluster of each abstract node
+		std::vector<int32_t> m_Rebuild;       //clusters of the current Update
+		PathScratch m_BuildScratch;
+		int32_t m_NumClusterBuilds = 0;
+
+		int32_t GetCluster(int32_t index) const;
+		ClusterBounds GetBounds(int32_t cluster) const;
+		void BuildCluster(const Grid& grid, int32_t cluster);
+		//entrances of one border of the cluster, towards the neighbor in direction
+		void AddEntrances(const Grid& grid, int32_t cluster, int32_t direction);
+		//the entrance of a cluster at a cell, -1 if it isn't one
+		int32_t FindNode(int32_t cluster, int32_t cell) const;
+
+		//A* from source to goal without leaving the bounds, or with a goal of -1 dijkstra to every cell of them. bToSource turns it around:
+		//the costs from every cell to source. the scratch holds local indices, see ClusterBounds::ToLocal. false if the goal wasn't reached
+		bool SearchBounds(const Grid& grid, const ClusterBounds& bounds, int32_t source, int32_t goal, bool bToSource, PathScratch& scratch) const;
+		//appends the cheapest path inside the cluster from start to goal, start itself left out
+		bool RefineInCluster(const Grid& grid, int32_t cluster, int32_t start, int32_t goal, std::vector<int32_t>& outPath, PathScratch& scratch,
+			HierarchicalScratch& hierarchicalScratch) const;
+	};
+}
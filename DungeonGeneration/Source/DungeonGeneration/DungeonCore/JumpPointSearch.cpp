@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "JumpPointSearch.h"
+
+#include <algorithm>
+
+namespace DungeonCore
+{
+	namespace
+	{
+		//true if position lies strictly between from and to, walking from from in direction step
+		bool IsBetween(int32_t position, int32_t from, int32_t to, int32_t step)
+		{
+			return step > 0 ? (position > from && position < to) : (position < from && position > to);
+		}
+
+		//the first blocked position after from in direction step, or the border (-1 or size) if the line is open
+		int32_t FindWall(const std::vector<int32_t>& blocked, int32_t from, int32_t step, int32_t size)
+		{
+			if (step > 0)
+			{
+				const auto it = std::upper_bound(blocked.begin(), blocked.end(), from);
+				return it == blocked.end() ? size : *it;
+			}
+			const auto it = std::lower_bound(blocked.begin(), blocked.end(), from);
+			return it == blocked.begin() ? -1 : *(it - 1);
+		}
+
+		//x is the column and y the row of a cell
+		class Jumper
+		{
+		public:
+			Jumper(const Grid& grid, int32_t goal)
+				: m_Grid(grid),
+				m_Columns(grid.GetNrColumns()),
+				m_Rows(grid.GetNrRows()),
+				m_GoalX(goal % grid.GetNrColumns()),
+				m_GoalY(goal / grid.GetNrColumns())
+			{
+			}
+
+			bool IsBlocked(int32_t x, int32_t y) const
+			{
+				return x >= 0 && x < m_Columns && y >= 0 && y < m_Rows && m_Grid.IsBlocked(y * m_Columns + x);
+			}
+			bool IsFree(int32_t x, int32_t y) const
+			{
+				return x >= 0 && x < m_Columns && y >= 0 && y < m_Rows && !m_Grid.IsBlocked(y * m_Columns + x);
+			}
+
+			//row of the first jump point from (x, y) going stepY, the goal or a cell with a forced turn sideways. -1 if a wall comes first
+			int32_t JumpVertical(int32_t x, int32_t y, int32_t stepY) const
+			{
+				const int32_t wall = FindWall(m_Grid.GetBlockedRows(x), y, stepY, m_Rows);
+				int32_t stop = wall;
+				if (x == m_GoalX && IsBetween(m_GoalY, y, stop, stepY))
+					stop = m_GoalY;
+
+				//a turn is forced at the row right after a blocked cell beside the run, when the cell beside that row is open
+				for (int32_t side = x - 1; side <= x + 1; side += 2)
+				{
+					if (side < 0 || side >= m_Columns)
+						continue;
+
+					const std::vector<int32_t>& blocked = m_Grid.GetBlockedRows(side);
+					if (stepY > 0)
+					{
+						for (auto it = std::lower_bound(blocked.begin(), blocked.end(), y); it != blocked.end() && *it + 1 < stop; ++it)
+						{
+							if (it + 1 == blocked.end() || *(it + 1) != *it + 1)
+							{
+								stop = *it + 1;
+								break;
+							}
+						}
+					}
+					else
+					{
+						for (auto it = std::upper_bound(blocked.begin(), blocked.end(), y); it != blocked.begin() && *(it - 1) - 1 > stop; --it)
+						{
+							if (it - 1 == blocked.begin() || *(it - 2) != *(it - 1) - 1)
+							{
+								stop = *(it - 1) - 1;
+								break;
+							}
+						}
+					}
+				}
+				return stop == wall ? -1 : stop;
+			}
+
+			//column of the first jump point from (x, y) going stepX: the goal, or a cell a vertical jump leaves from. -1 if a wall comes first.
+			//a vertical jump can only find something in the goal's column or next to a column with blocked cells, the others are skipped
+			int32_t JumpHorizontal(int32_t x, int32_t y, int32_t stepX) const
+			{
+				const int32_t wall = FindWall(m_Grid.GetBlockedColumns(y), x, stepX, m_Columns);
+				const std::vector<int32_t>& walled = m_Grid.GetColumnsWithBlockedCells();
+				for (int32_t column = x;;)
+				{
+					int32_t next = wall;
+					const auto consider = [&next, column, stepX](int32_t candidate)
+					{
+						if (IsBetween(candidate, column, next, stepX))
+							next = candidate;
+					};
+					consider(m_GoalX);
+					if (stepX > 0)
+					{
+						//columns b + 1 past the current one, and b - 1
+						const auto right = std::lower_bound(walled.begin(), walled.end(), column);
+						if (right != walled.end())
+							consider(*right + 1);
+						const auto left = std::lower_bound(walled.begin(), walled.end(), column + 2);
+						if (left != walled.end())
+							consider(*left - 1);
+					}
+					else
+					{
+						const auto left = std::upper_bound(walled.begin(), walled.end(), column);
+						if (left != walled.begin())
+							consider(*(left - 1) - 1);
+						const auto right = std::upper_bound(walled.begin(), walled.end(), column - 2);
+						if (right != walled.begin())
+							consider(*(right - 1) + 1);
+					}
+
+					if (next == wall)
+						return -1;
+					if ((next == m_GoalX && y == m_GoalY) || JumpVertical(next, y, 1) >= 0 || JumpVertical(next, y, -1) >= 0)
+						return next;
+					column = next;
+				}
+			}
+
+		private:
+			const Grid& m_Grid;
+			int32_t m_Columns;
+			int32_t m_Rows;
+			int32_t m_GoalX;
+			int32_t m_GoalY;
+		};
+	}
+
+	bool FindJumpPointPath(const Grid& grid, const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& scratch)
+	{
+		outPath.clear();
+		const int32_t startIndex = request.start;
+		const int32_t endIndex = request.end;
+		//nothing jumps onto a blocked goal, no need to search the whole grid for it
+		if (grid.IsBlocked(endIndex) && startIndex != endIndex)
+			return false;
+
+		const int32_t columns = grid.GetNrColumns();
+		const Jumper jumper(grid, endIndex);
+
+		//same scratch as A*, the parents are the previous jump point and the costs the cells walked so far
+		scratch.BeginSearch(grid.GetArraySize(), request.tieBreakSalt);
+		scratch.Push(startIndex, -1, 0.f, grid.GetHeuristicCost(startIndex, endIndex));
+
+		bool bFound = false;
+		while (!scratch.IsOpenEmpty())
+		{
+			const int32_t current = scratch.PopLowest();
+			if (current == endIndex)
+			{
+				bFound = true;
+				break;
+			}
+
+			const int32_t x = current % columns;
+			const int32_t y = current / columns;
+			const int32_t parent = scratch.GetParent(current);
+
+			//the directions worth jumping in, pruned by the way in. the start has no way in and tries all four
+			int32_t numDirections = 0;
+			int32_t directions[4][2];
+			const auto addDirection = [&numDirections, &directions](int32_t stepX, int32_t stepY)
+			{
+				directions[numDirections][0] = stepX;
+				directions[numDirections][1] = stepY;
+				++numDirections;
+			};
+			if (parent == -1)
+			{
+				addDirection(1, 0);
+				addDirection(0, 1);
+				addDirection(-1, 0);
+				addDirection(0, -1);
+			}
+			else if (parent / columns == y)
+			{
+				//reached horizontally: keep going, or turn either way
+				addDirection(x > parent % columns ? 1 : -1, 0);
+				addDirection(0, 1);
+				addDirection(0, -1);
+			}
+			else
+			{
+				//reached vertically: keep going, and turn only where the cell behind the turn is blocked
+				const int32_t stepY = y > parent / columns ? 1 : -1;
+				addDirection(0, stepY);
+				for (int32_t stepX = -1; stepX <= 1; stepX += 2)
+				{
+					if (jumper.IsFree(x + stepX, y) && jumper.IsBlocked(x + stepX, y - stepY))
+						addDirection(stepX, 0);
+				}
+			}
+
+			const float currentCost = scratch.GetCostSoFar(current);
+			for (int32_t i{ 0 }; i < numDirections; ++i)
+			{
+				int32_t jumpPoint = -1;
+				if (directions[i][0] != 0)
+				{
+					const int32_t jumpX = jumper.JumpHorizontal(x, y, directions[i][0]);
+					if (jumpX >= 0)
+						jumpPoint = y * columns + jumpX;
+				}
+				else
+				{
+					const int32_t jumpY = jumper.JumpVertical(x, y, directions[i][1]);
+					if (jumpY >= 0)
+						jumpPoint = jumpY * columns + x;
+				}
+
+				if (jumpPoint == -1 || scratch.IsClosed(jumpPoint))
+					continue;
+
+				//the jump is a straight line, its length is the manhattan distance
+				const float costSoFar = currentCost + grid.GetHeuristicCost(current, jumpPoint);
+				if (scratch.IsVisited(jumpPoint) && scratch.GetCostSoFar(jumpPoint) <= costSoFar)
+					continue;
+
+				scratch.Push(jumpPoint, current, costSoFar, costSoFar + grid.GetHeuristicCost(jumpPoint, endIndex));
+			}
+		}
+
+		if (!bFound)
+			return false;
+
+		//walk back through the jump points, filling in the cells of each straight run
+		for (int32_t point = endIndex; point != -1;)
+		{
+			const int32_t previous = scratch.GetParent(point);
+			if (previous == -1)
+			{
+				outPath.push_back(point);
+				break;
+			}
+
+			const int32_t step = previous / columns == point / columns ? (previous > point ? 1 : -1) : (previous > point ? columns : -columns);
+			for (int32_t cell = point; cell != previous; cell += step)
+			{
+				outPath.push_back(cell);
+			}
+			point = previous;
+		}
+
+		std::reverse(outPath.begin(), outPath.end());
+		return true;
+	}
+}
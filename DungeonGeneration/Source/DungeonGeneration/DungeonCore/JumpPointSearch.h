@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Grid.h"
+
+namespace DungeonCore
+{
+	//Jump point search for four neighbors, on a grid where every step costs 1 and blocked cells are walls.
+	//Paths are ordered horizontal moves first: a vertical move only turns sideways where the cell behind the turn is blocked,
+	//and a horizontal run only stops where a vertical jump from it finds something. Only those jump points go through the heap,
+	//the straight runs in between are skipped with the grid's sorted blocked lists, so an open grid costs a handful of expansions.
+	//the path is as short as Grid::AStarPath's, though it may take another route of the same length.
+	//the caller checks Grid::HasUniformCost, the weights of the cells are not looked at
+	bool FindJumpPointPath(const Grid& grid, const PathRequest& request, std::vector<int32_t>& outPath, PathScratch& scratch);
+}
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LayoutArchive.h"
+
+namespace DungeonCore
+{
+	namespace
+	{
+		constexpr uint32_t IndexMagic = 0x58494C44; //"DLIX"
+		constexpr uint32_t IndexVersion = 1;
+
+		std::string GetIndexPath(const std::string& path)
+		{
+			return path + ".index";
+		}
+
+		//fseek only takes a long, which is 32 bits on Windows
+		bool SeekTo(FILE* pFile, uint64_t offset)
+		{
+#ifdef _WIN32
+			return _fseeki64(pFile, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+			return fseeko(pFile, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+		}
+
+		//opens for reading and writing without truncating, creating the file if needed
+		FILE* OpenForUpdate(const std::string& path)
+		{
+			FILE* pFile = std::fopen(path.c_str(), "r+b");
+			return pFile != nullptr ? pFile : std::fopen(path.c_str(), "w+b");
+		}
+	}
+
+	LayoutArchiveWriter::~LayoutArchiveWriter()
+	{
+		Close();
+	}
+
+	bool LayoutArchiveWriter::Open(const std::string& path, const GenerationParams& params)
+	{
+		Close();
+
+		m_pData = OpenForUpdate(path);
+		m_pIndex = OpenForUpdate(GetIndexPath(path));
+		uint64_t indexSize = 0;
+		if (m_pData == nullptr || m_pIndex == nullptr || !QueryFileSize(GetIndexPath(path), indexSize))
+		{
+			Close();
+			return false;
+		}
+
+		LayoutIndexHeader header;
+		header.magic = IndexMagic;
+		header.version = IndexVersion;
+		header.paramsKey = GetLayoutKey(params, 0);
+
+		if (indexSize < sizeof(LayoutIndexHeader))
+		{
+			//new archive
+			m_NumLayouts = 0;
+			m_DataSize = 0;
+			if (!SeekTo(m_pIndex, 0) || std::fwrite(&header, sizeof(header), 1, m_pIndex) != 1)
+			{
+				Close();
+				return false;
+			}
+		}
+		else
+		{
+			//existing archive, it has to be one of the same params
+			LayoutIndexHeader existing;
+			if (!SeekTo(m_pIndex, 0) || std::fread(&existing, sizeof(existing), 1, m_pIndex) != 1
+				|| existing.magic != header.magic || existing.version != header.version || existing.paramsKey != header.paramsKey)
+			{
+				Close();
+				return false;
+			}
+
+			//a partly written entry at the end doesn't count
+			m_NumLayouts = (indexSize - sizeof(LayoutIndexHeader)) / sizeof(LayoutIndexEntry);
+			m_DataSize = 0;
+			if (m_NumLayouts > 0)
+			{
+				LayoutIndexEntry last;
+				if (!SeekTo(m_pIndex, sizeof(LayoutIndexHeader) + (m_NumLayouts - 1) * sizeof(LayoutIndexEntry))
+					|| std::fread(&last, sizeof(last), 1, m_pIndex) != 1)
+				{
+					Close();
+					return false;
+				}
+				m_DataSize = last.offset + last.size;
+			}
+		}
+
+		//write right after the last indexed layout
+		if (!SeekTo(m_pIndex, sizeof(LayoutIndexHeader) + m_NumLayouts * sizeof(LayoutIndexEntry)) || !SeekTo(m_pData, m_DataSize))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	bool LayoutArchiveWriter::Append(uint64_t seed, const std::vector<uint8_t>& bytes)
+	{
+		if (m_pData == nullptr)
+			return false;
+
+		LayoutIndexEntry entry;
+		entry.seed = seed;
+		entry.offset = m_DataSize;
+		entry.size = bytes.size();
+
+		if (!bytes.empty() && std::fwrite(bytes.data(), 1, bytes.size(), m_pData) != bytes.size())
+			return false;
+		if (std::fwrite(&entry, sizeof(entry), 1, m_pIndex) != 1)
+			return false;
+
+		m_DataSize += bytes.size();
+		++m_NumLayouts;
+		return true;
+	}
+
+	bool LayoutArchiveWriter::Flush()
+	{
+		if (m_pData == nullptr)
+			return false;
+
+		return std::fflush(m_pData) == 0 && std::fflush(m_pIndex) == 0;
+	}
+
+	bool LayoutArchiveWriter::Close()
+	{
+		bool bClosed = true;
+		if (m_pData != nullptr)
+			bClosed = std::fclose(m_pData) == 0 && bClosed;
+		if (m_pIndex != nullptr)
+			bClosed = std::fclose(m_pIndex) == 0 && bClosed;
+
+		m_pData = nullptr;
+		m_pIndex = nullptr;
+		return bClosed;
+	}
+
+	bool LayoutArchive::Open(const std::string& path)
+	{
+		Close();
+
+		if (!m_Index.Open(GetIndexPath(path)) || m_Index.GetSize() < sizeof(LayoutIndexHeader))
+		{
+			Close();
+			return false;
+		}
+
+		const LayoutIndexHeader* pHeader = reinterpret_cast<const LayoutIndexHeader*>(m_Index.GetData());
+		if (pHeader->magic != IndexMagic || pHeader->version != IndexVersion)
+		{
+			Close();
+			return false;
+		}
+
+		m_pEntries = reinterpret_cast<const LayoutIndexEntry*>(m_Index.GetData() + sizeof(LayoutIndexHeader));
+		m_NumLayouts = (m_Index.GetSize() - sizeof(LayoutIndexHeader)) / sizeof(LayoutIndexEntry);
+
+		//an archive with no layouts yet has an empty data file, which can't be mapped
+		if (m_NumLayouts > 0 && !m_Data.Open(path))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void LayoutArchive::Close()
+	{
+		m_Data.Close();
+		m_Index.Close();
+		m_pEntries = nullptr;
+		m_NumLayouts = 0;
+	}
+
+	bool LayoutArchive::GetLayout(uint64_t index, LayoutView& outView) const
+	{
+		const LayoutIndexEntry& entry = m_pEntries[index];
+		if (entry.offset > m_Data.GetSize() || entry.size > m_Data.GetSize() - entry.offset)
+			return false;
+
+		return ReadLayout(m_Data.GetData() + entry.offset, static_cast<size_t>(entry.size), outView);
+	}
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "LayoutCache.h"
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <string>
+
+namespace DungeonCore
+{
+	//One entry of an archive's index file, path + ".index". The index starts with a LayoutIndexHeader.
+	struct LayoutIndexEntry
+	{
+		uint64_t seed = 0;
+		uint64_t offset = 0; //into the data file, always 8-byte aligned
+		uint64_t size = 0;
+	};
+
+	struct LayoutIndexHeader
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t paramsKey = 0; //GetLayoutKey(params, 0), an archive only ever holds one set of params
+	};
+
+	//Appends serialized layouts (see WriteLayout) to an archive: the data file gets the bytes, the index file one entry each.
+	//Reopening appends after the last indexed layout, so anything a crash left half written is overwritten.
+	class LayoutArchiveWriter
+	{
+	public:
+		LayoutArchiveWriter() {};
+		~LayoutArchiveWriter();
+
+		LayoutArchiveWriter(const LayoutArchiveWriter&) = delete;
+		LayoutArchiveWriter& operator=(const LayoutArchiveWriter&) = delete;
+
+		//creates the archive or opens it for appending. false if it can't be opened or holds other params
+		bool Open(const std::string& path, const GenerationParams& params);
+		bool Append(uint64_t seed, const std::vector<uint8_t>& bytes);
+		//pushes the written layouts to the OS, the data before the index so no entry points at missing bytes
+		bool Flush();
+		bool Close();
+
+		uint64_t GetNumLayouts() const { return m_NumLayouts; }
+		uint64_t GetDataSize() const { return m_DataSize; }
+
+	private:
+		FILE* m_pData = nullptr;
+		FILE* m_pIndex = nullptr;
+		uint64_t m_DataSize = 0;
+		uint64_t m_NumLayouts = 0;
+	};
+
+	//Read-only archive, both files memory-mapped. Layouts are read in place, nothing is loaded up front.
+	class LayoutArchive
+	{
+	public:
+		bool Open(const std::string& path);
+		void Close();
+
+		uint64_t GetNumLayouts() const { return m_NumLayouts; }
+		const LayoutIndexEntry& GetEntry(uint64_t index) const { return m_pEntries[index]; }
+		//false if the entry points outside the data file or the bytes are not a layout
+		bool GetLayout(uint64_t index, LayoutView& outView) const;
+
+	private:
+		MappedFile m_Data;
+		MappedFile m_Index;
+		const LayoutIndexEntry* m_pEntries = nullptr;
+		uint64_t m_NumLayouts = 0;
+	};
+}
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LayoutCache.h"
+
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+
+namespace DungeonCore
+{
+	namespace
+	{
+		constexpr uint32_t LayoutMagic = 0x59414C44; //"DLAY"
+		constexpr uint32_t LayoutVersion = 1;
+
+		size_t Align8(size_t size)
+		{
+			return (size + 7) & ~static_cast<size_t>(7);
+		}
+
+		size_t GetNumCorridorWords(int32_t numCells)
+		{
+			return (static_cast<size_t>(numCells) + 63) / 64;
+		}
+
+		//FNV-1a, fed one field at a time so struct padding never ends up in the key
+		template<typename T>
+		void HashValue(uint64_t& hash, const T& value)
+		{
+			uint8_t bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			for (uint8_t byte : bytes)
+			{
+				hash = (hash ^ byte) * 0x100000001B3ULL;
+			}
+		}
+
+		template<typename T>
+		void AppendBytes(std::vector<uint8_t>& outBytes, const T* pValues, size_t count)
+		{
+			const size_t offset = outBytes.size();
+			outBytes.resize(offset + Align8(sizeof(T) * count));
+			if (count > 0)
+				std::memcpy(outBytes.data() + offset, pValues, sizeof(T) * count);
+		}
+
+		void AppendEdges(std::vector<uint8_t>& outBytes, const std::vector<TriangulationEdge>& edges)
+		{
+			std::vector<LayoutEdge> layoutEdges(edges.size());
+			for (size_t i{ 0 }; i < edges.size(); ++i)
+			{
+				layoutEdges[i].vertex[0] = edges[i].vertex[0];
+				layoutEdges[i].vertex[1] = edges[i].vertex[1];
+			}
+			AppendBytes(outBytes, layoutEdges.data(), layoutEdges.size());
+		}
+	}
+
+	int32_t LayoutView::CountCorridorCells() const
+	{
+		//the bits past the last cell are never set
+		int32_t count = 0;
+		const size_t numWords = GetNumCorridorWords(GetNumCells());
+		for (size_t word{ 0 }; word < numWords; ++word)
+		{
+			count += static_cast<int32_t>(std::bitset<64>(pCorridorBits[word]).count());
+		}
+		return count;
+	}
+
+	uint64_t GetLayoutKey(const GenerationParams& params, uint64_t seed)
+	{
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		HashValue(hash, LayoutVersion);
+		HashValue(hash, seed);
+		HashValue(hash, params.numberRooms);
+		HashValue(hash, params.nrRows);
+		HashValue(hash, params.nrColumns);
+		HashValue(hash, params.cellWidth);
+		HashValue(hash, params.cellDepth);
+		HashValue(hash, params.minRoomSize);
+		HashValue(hash, params.maxRoomSize);
+		HashValue(hash, params.roomMargin);
+		HashValue(hash, params.maxPlacementAttempts);
+		HashValue(hash, params.placementMode);
+		HashValue(hash, params.poissonCandidates);
+		HashValue(hash, params.corridorCostScale);
+		HashValue(hash, params.loopEdgeRatio);
+		HashValue(hash, params.corridorSearch);
+		return hash;
+	}
+
+	void WriteLayout(const GenerationParams& params, uint64_t seed, const std::vector<Room>& rooms, bool allRoomsPlaced,
+		const Graph& graph, const Grid& grid, std::vector<uint8_t>& outBytes)
+	{
+		LayoutHeader header;
+		header.magic = LayoutMagic;
+		header.version = LayoutVersion;
+		header.key = GetLayoutKey(params, seed);
+		header.seed = seed;
+		header.nrRows = grid.GetNrRows();
+		header.nrColumns = grid.GetNrColumns();
+		header.numRooms = static_cast<int32_t>(rooms.size());
+		header.numMSTEdges = static_cast<int32_t>(graph.GetMSTEdges().size());
+		header.numLoopEdges = static_cast<int32_t>(graph.GetLoopEdges().size());
+		header.flags = allRoomsPlaced ? static_cast<uint32_t>(LayoutFlags::AllRoomsPlaced) : 0;
+		AppendBytes(outBytes, &header, 1);
+
+		std::vector<LayoutRoom> layoutRooms(rooms.size());
+		for (size_t i{ 0 }; i < rooms.size(); ++i)
+		{
+			layoutRooms[i].centerX = rooms[i].center.X;
+			layoutRooms[i].centerY = rooms[i].center.Y;
+			layoutRooms[i].cellIndex = rooms[i].cellIndex;
+			layoutRooms[i].width = rooms[i].width;
+			layoutRooms[i].depth = rooms[i].depth;
+		}
+		AppendBytes(outBytes, layoutRooms.data(), layoutRooms.size());
+
+		AppendEdges(outBytes, graph.GetMSTEdges());
+		AppendEdges(outBytes, graph.GetLoopEdges());
+
+		//the grid keeps the same bitset, word for word
+		std::vector<uint64_t> corridorBits(GetNumCorridorWords(grid.GetArraySize()), 0);
+		for (size_t word{ 0 }; word < corridorBits.size(); ++word)
+		{
+			corridorBits[word] = grid.GetCorridorWord(static_cast<int32_t>(word));
+		}
+		AppendBytes(outBytes, corridorBits.data(), corridorBits.size());
+	}
+
+	bool ReadLayout(const uint8_t* pData, size_t size, LayoutView& outView)
+	{
+		if (pData == nullptr || size < sizeof(LayoutHeader))
+			return false;
+
+		const LayoutHeader* pHeader = reinterpret_cast<const LayoutHeader*>(pData);
+		if (pHeader->magic != LayoutMagic || pHeader->version != LayoutVersion)
+			return false;
+
+		if (pHeader->nrRows <= 0 || pHeader->nrColumns <= 0 || pHeader->numRooms < 0 || pHeader->numMSTEdges < 0 || pHeader->numLoopEdges < 0)
+			return false;
+
+		//the header comes straight from the file, a product past the grid maximum would wrap and slip through the size check below
+		const int64_t numCells = static_cast<int64_t>(pHeader->nrRows) * pHeader->nrColumns;
+		if (numCells > Grid::MaxCells)
+			return false;
+
+		//section offsets, then one check that they all fit
+		const size_t roomsOffset = Align8(sizeof(LayoutHeader));
+		const size_t mstOffset = roomsOffset + Align8(sizeof(LayoutRoom) * pHeader->numRooms);
+		const size_t loopOffset = mstOffset + Align8(sizeof(LayoutEdge) * pHeader->numMSTEdges);
+		const size_t bitsOffset = loopOffset + Align8(sizeof(LayoutEdge) * pHeader->numLoopEdges);
+		const size_t endOffset = bitsOffset + sizeof(uint64_t) * GetNumCorridorWords(static_cast<int32_t>(numCells));
+		if (endOffset > size)
+			return false;
+
+		//the indices are used without checks later on
+		const LayoutRoom* pRooms = reinterpret_cast<const LayoutRoom*>(pData + roomsOffset);
+		for (int32_t i{ 0 }; i < pHeader->numRooms; ++i)
+		{
+			if (pRooms[i].cellIndex < 0 || pRooms[i].cellIndex >= numCells)
+				return false;
+		}
+
+		outView.pHeader = pHeader;
+		outView.pRooms = pRooms;
+		outView.pMSTEdges = reinterpret_cast<const LayoutEdge*>(pData + mstOffset);
+		outView.pLoopEdges = reinterpret_cast<const LayoutEdge*>(pData + loopOffset);
+		outView.pCorridorBits = reinterpret_cast<const uint64_t*>(pData + bitsOffset);
+		return true;
+	}
+
+	void ApplyLayout(const LayoutView& view, Grid& grid, std::vector<Room>& outRooms)
+	{
+		outRooms.resize(view.pHeader->numRooms);
+		for (int32_t i{ 0 }; i < view.pHeader->numRooms; ++i)
+		{
+			const LayoutRoom& layoutRoom = view.pRooms[i];
+			Room& room = outRooms[i];
+			room.center = Vec2(layoutRoom.centerX, layoutRoom.centerY);
+			room.cellIndex = layoutRoom.cellIndex;
+			room.width = layoutRoom.width;
+			room.depth = layoutRoom.depth;
+			grid.SetRoom(room.cellIndex);
+		}
+
+		//a word at a time, most of the grid is not corridor. the bits past the last cell of a damaged file are left alone
+		const int32_t numCells = view.GetNumCells();
+		const size_t numWords = GetNumCorridorWords(numCells);
+		for (size_t word{ 0 }; word < numWords; ++word)
+		{
+			const uint64_t bits = view.pCorridorBits[word];
+			if (bits == 0)
+				continue;
+
+			for (int32_t bit{ 0 }; bit < 64; ++bit)
+			{
+				const int64_t cell = static_cast<int64_t>(word) * 64 + bit;
+				if (cell >= numCells)
+					break;
+				if ((bits >> bit) & 1)
+					grid.MarkCorridorCell(static_cast<int32_t>(cell));
+			}
+		}
+	}
+
+	bool LayoutCache::Find(const GenerationParams& params, uint64_t seed, LayoutView& outView)
+	{
+		const uint64_t key = GetLayoutKey(params, seed);
+		if (m_Directory.empty() || !m_File.Open(GetPath(key)))
+			return false;
+
+		//a file from another version or a key collision is a miss
+		if (!ReadLayout(m_File.GetData(), m_File.GetSize(), outView)
+			|| outView.pHeader->key != key || outView.pHeader->seed != seed
+			|| outView.pHeader->nrRows != params.nrRows || outView.pHeader->nrColumns != params.nrColumns)
+		{
+			m_File.Close();
+			return false;
+		}
+		return true;
+	}
+
+	bool LayoutCache::Store(const GenerationParams& params, uint64_t seed, const std::vector<Room>& rooms, bool allRoomsPlaced,
+		const Graph& graph, const Grid& grid)
+	{
+		if (m_Directory.empty() || !CreateDirectories(m_Directory))
+			return false;
+
+		m_File.Close();
+		m_Bytes.clear();
+		WriteLayout(params, seed, rooms, allRoomsPlaced, graph, grid, m_Bytes);
+
+		const std::string path = GetPath(GetLayoutKey(params, seed));
+		const std::string temporaryPath = path + ".tmp";
+
+		FILE* pFile = std::fopen(temporaryPath.c_str(), "wb");
+		if (pFile == nullptr)
+			return false;
+
+		const bool bWritten = std::fwrite(m_Bytes.data(), 1, m_Bytes.size(), pFile) == m_Bytes.size();
+		if (std::fclose(pFile) != 0 || !bWritten)
+		{
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+
+		//rename doesn't replace an existing file everywhere
+		std::remove(path.c_str());
+		if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+		{
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	std::string LayoutCache::GetPath(uint64_t key) const
+	{
+		char fileName[32];
+		std::snprintf(fileName, sizeof(fileName), "%016llx.dlay", static_cast<unsigned long long>(key));
+		return m_Directory + "/" + fileName;
+	}
+}
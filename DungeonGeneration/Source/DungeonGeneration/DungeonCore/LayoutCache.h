@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "Graph.h"
+#include "Grid.h"
+#include "MappedFile.h"
+
+#include <string>
+
+namespace DungeonCore
+{
+	//Binary layout format, little endian. Header, then the rooms, MST edges, loop edges and one corridor bit per cell,
+	//every section starting 8-byte aligned so it can be read in place from a memory mapping.
+	struct LayoutHeader
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t key = 0;  //GetLayoutKey of the params and seed that produced it
+		uint64_t seed = 0;
+		int32_t nrRows = 0;
+		int32_t nrColumns = 0;
+		int32_t numRooms = 0;
+		int32_t numMSTEdges = 0;
+		int32_t numLoopEdges = 0;
+		uint32_t flags = 0; //LayoutFlags bits
+	};
+
+	enum class LayoutFlags : uint32_t
+	{
+		AllRoomsPlaced = 1 << 0
+	};
+
+	//a room rect, the center is on a cell center
+	struct LayoutRoom
+	{
+		float centerX = 0.f;
+		float centerY = 0.f;
+		int32_t cellIndex = -1;
+		int32_t width = 0;
+		int32_t depth = 0;
+	};
+
+	//room index pair
+	struct LayoutEdge
+	{
+		int32_t vertex[2] = { -1, -1 };
+	};
+
+	//Read-only view of one serialized layout, pointing into the bytes it was read from
+	struct LayoutView
+	{
+		const LayoutHeader* pHeader = nullptr;
+		const LayoutRoom* pRooms = nullptr;
+		const LayoutEdge* pMSTEdges = nullptr;
+		const LayoutEdge* pLoopEdges = nullptr;
+		const uint64_t* pCorridorBits = nullptr; //bit i of word i / 64 is cell i
+
+		//ReadLayout has checked it is at most Grid::MaxCells
+		int32_t GetNumCells() const { return static_cast<int32_t>(static_cast<int64_t>(pHeader->nrRows) * pHeader->nrColumns); }
+		bool AllRoomsPlaced() const { return (pHeader->flags & static_cast<uint32_t>(LayoutFlags::AllRoomsPlaced)) != 0; }
+		bool IsCorridor(int32_t cell) const { return (pCorridorBits[cell >> 6] >> (cell & 63)) & 1; }
+		int32_t CountCorridorCells() const;
+	};
+
+	//hash of the seed and every param that changes the layout, a different key is a different dungeon
+	uint64_t GetLayoutKey(const GenerationParams& params, uint64_t seed);
+
+	//appends one layout to outBytes: the rooms, the graph's MST and loop edges and the grid's corridor cells
+	void WriteLayout(const GenerationParams& params, uint64_t seed, const std::vector<Room>& rooms, bool allRoomsPlaced,
+		const Graph& graph, const Grid& grid, std::vector<uint8_t>& outBytes);
+	//checks the header and the section sizes against size. the view points into pData
+	bool ReadLayout(const uint8_t* pData, size_t size, LayoutView& outView);
+	//puts the rooms and corridors of the view on an emptied grid of the same size, as if they were just generated
+	void ApplyLayout(const LayoutView& view, Grid& grid, std::vector<Room>& outRooms);
+
+	//Directory of layouts, one file per key. A hit maps the file, nothing is generated or copied.
+	class LayoutCache
+	{
+	public:
+		//the directory is created on the first Store
+		void SetDirectory(const std::string& directory) { m_Directory = directory; }
+		const std::string& GetDirectory() const { return m_Directory; }
+
+		//true if the layout is cached. outView stays valid until the next Find or Store
+		bool Find(const GenerationParams& params, uint64_t seed, LayoutView& outView);
+		//writes the layout the generation left in the graph and grid, through a temporary file so readers never see half of it
+		bool Store(const GenerationParams& params, uint64_t seed, const std::vector<Room>& rooms, bool allRoomsPlaced,
+			const Graph& graph, const Grid& grid);
+
+	private:
+		std::string m_Directory;
+		MappedFile m_File;
+		std::vector<uint8_t> m_Bytes;
+
+		std::string GetPath(uint64_t key) const;
+	};
+}
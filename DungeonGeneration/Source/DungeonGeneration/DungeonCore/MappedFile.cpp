@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DungeonCore
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (pView == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		m_pData = static_cast<const uint8_t*>(pView);
+		m_Size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_pData != nullptr)
+			UnmapViewOfFile(m_pData);
+		if (m_MappingHandle != nullptr)
+			CloseHandle(m_MappingHandle);
+		if (m_FileHandle != nullptr)
+			CloseHandle(m_FileHandle);
+
+		m_pData = nullptr;
+		m_Size = 0;
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+	}
+
+	namespace
+	{
+		void MakeDirectory(const std::string& path)
+		{
+			_mkdir(path.c_str());
+		}
+
+		bool IsDirectory(const std::string& path)
+		{
+			const DWORD attributes = GetFileAttributesA(path.c_str());
+			return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		}
+	}
+
+	bool QueryFileSize(const std::string& path, uint64_t& outSize)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+			return false;
+
+		outSize = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+		return true;
+	}
+#else
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		//the mapping keeps its own reference to the file
+		void* pView = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (pView == MAP_FAILED)
+			return false;
+
+		m_pData = static_cast<const uint8_t*>(pView);
+		m_Size = static_cast<size_t>(status.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_pData != nullptr)
+			munmap(const_cast<uint8_t*>(m_pData), m_Size);
+
+		m_pData = nullptr;
+		m_Size = 0;
+	}
+
+	namespace
+	{
+		void MakeDirectory(const std::string& path)
+		{
+			mkdir(path.c_str(), 0755);
+		}
+
+		bool IsDirectory(const std::string& path)
+		{
+			struct stat status;
+			return stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+		}
+	}
+
+	bool QueryFileSize(const std::string& path, uint64_t& outSize)
+	{
+		struct stat status;
+		if (stat(path.c_str(), &status) != 0)
+			return false;
+
+		outSize = static_cast<uint64_t>(status.st_size);
+		return true;
+	}
+#endif
+
+	bool CreateDirectories(const std::string& path)
+	{
+		//every prefix ending in a separator, some of them (a drive, the root) can't be created and don't have to be
+		for (size_t i{ 1 }; i < path.size(); ++i)
+		{
+			if (path[i] == '/' || path[i] == '\\')
+				MakeDirectory(path.substr(0, i));
+		}
+		MakeDirectory(path);
+		return IsDirectory(path);
+	}
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+#include <string>
+
+namespace DungeonCore
+{
+	//Read-only memory mapping of a whole file. The pages are loaded by the OS on first touch,
+	//so opening a big file costs nothing until its bytes are read.
+	class MappedFile
+	{
+	public:
+		MappedFile() {};
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//maps the file, closing the previous one. false if it can't be opened or is empty
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return m_pData != nullptr; }
+		const uint8_t* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		const uint8_t* m_pData = nullptr;
+		size_t m_Size = 0;
+#ifdef _WIN32
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+	};
+
+	//creates the directory and its parents, true if it exists afterwards
+	bool CreateDirectories(const std::string& path);
+	//false if the file doesn't exist
+	bool QueryFileSize(const std::string& path, uint64_t& outSize);
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Parallel.h"
+
+#include <algorithm>
+
+namespace DungeonCore
+{
+	ThreadPool::ThreadPool(int32_t numWorkers)
+	{
+		if (numWorkers <= 0)
+			numWorkers = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+
+		//worker 0 is whoever calls For
+		for (int32_t worker{ 1 }; worker < numWorkers; ++worker)
+		{
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_bStop = true;
+		}
+		m_WakeCondition.notify_all();
+
+		for (std::thread& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::For(int32_t count, const std::function<void(int32_t index, int32_t worker)>& body)
+	{
+		if (count <= 0)
+			return;
+
+		//nothing to share the work with
+		if (m_Threads.empty() || count == 1)
+		{
+			for (int32_t index{ 0 }; index < count; ++index)
+			{
+				body(index, 0);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_pBody = &body;
+			m_Count = count;
+			m_NextIndex.store(0);
+			m_NumBusy = static_cast<int32_t>(m_Threads.size());
+			++m_Job;
+		}
+		m_WakeCondition.notify_all();
+
+		RunJob(0);
+
+		//every worker has to check in before body goes out of scope
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this] { return m_NumBusy == 0; });
+		m_pBody = nullptr;
+	}
+
+	void ThreadPool::WorkerLoop(int32_t worker)
+	{
+		uint64_t lastJob = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WakeCondition.wait(lock, [this, lastJob] { return m_bStop || m_Job != lastJob; });
+				if (m_bStop)
+					return;
+				lastJob = m_Job;
+			}
+
+			RunJob(worker);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_NumBusy == 0)
+				m_DoneCondition.notify_one();
+		}
+	}
+
+	void ThreadPool::RunJob(int32_t worker)
+	{
+		//grab indices until they run out
+		for (int32_t index = m_NextIndex.fetch_add(1); index < m_Count; index = m_NextIndex.fetch_add(1))
+		{
+			(*m_pBody)(index, worker);
+		}
+	}
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace DungeonCore
+{
+	//Runs independent work items on several threads. The core only sees this interface,
+	//the engine plugs in ParallelFor (see FTaskGraphExecutor in DataTypes.h), headless code uses ThreadPool.
+	class ParallelExecutor
+	{
+	public:
+		virtual ~ParallelExecutor() {};
+
+		//number of worker slots, body is only ever called with worker in [0, GetNumWorkers())
+		virtual int32_t GetNumWorkers() const = 0;
+		//calls body(index, worker) once for every index in [0, count) and returns when all are done.
+		//calls with the same worker never overlap, so per-worker state needs no locking
+		virtual void For(int32_t count, const std::function<void(int32_t index, int32_t worker)>& body) = 0;
+	};
+
+	//Fixed set of std::threads. The calling thread joins in as worker 0, indices are handed out one at a time.
+	class ThreadPool final : public ParallelExecutor
+	{
+	public:
+		//0 uses one worker per hardware thread
+		explicit ThreadPool(int32_t numWorkers = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		int32_t GetNumWorkers() const override { return static_cast<int32_t>(m_Threads.size()) + 1; }
+		void For(int32_t count, const std::function<void(int32_t index, int32_t worker)>& body) override;
+
+	private:
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeCondition;
+		std::condition_variable m_DoneCondition;
+
+		//current job, written under the mutex before the workers wake
+		const std::function<void(int32_t, int32_t)>* m_pBody = nullptr;
+		int32_t m_Count = 0;
+		uint64_t m_Job = 0;
+		int32_t m_NumBusy = 0;
+		bool m_bStop = false;
+
+		std::atomic<int32_t> m_NextIndex{ 0 };
+
+		void WorkerLoop(int32_t worker);
+		void RunJob(int32_t worker);
+	};
+}
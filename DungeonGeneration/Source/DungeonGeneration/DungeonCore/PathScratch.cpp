@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathScratch.h"
+
+#include <algorithm>
+
+namespace DungeonCore
+{
+	void PathScratch::BeginSearch(int32_t numCells, uint32_t tieBreakSalt)
+	{
+		m_TieBreakSalt = tieBreakSalt;
+
+		//only ever grows, so searches over graphs of different sizes can share a scratch
+		if (static_cast<int32_t>(m_Stamps.size()) < numCells)
+		{
+			m_Stamps.assign(numCells, 0);
+			m_CostSoFar.resize(numCells);
+			m_EstimatedTotalCost.resize(numCells);
+			m_Parent.resize(numCells);
+			m_HeapIndex.resize(numCells);
+			m_Generation = 0;
+		}
+
+		//the stamps wrapped around, old stamps could match again
+		if (++m_Generation == 0)
+		{
+			std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+			m_Generation = 1;
+		}
+
+		m_Heap.clear();
+		m_NumExpanded = 0;
+	}
+
+	void PathScratch::Push(int32_t cell, int32_t parent, float costSoFar, float estimatedTotalCost)
+	{
+		const bool bQueued = IsVisited(cell);
+
+		m_Stamps[cell] = m_Generation;
+		m_CostSoFar[cell] = costSoFar;
+		m_EstimatedTotalCost[cell] = estimatedTotalCost;
+		m_Parent[cell] = parent;
+
+		if (!bQueued)
+		{
+			m_Heap.push_back(cell);
+			m_HeapIndex[cell] = static_cast<int32_t>(m_Heap.size()) - 1;
+		}
+
+		//a cheaper cost only ever moves the cell up
+		SiftUp(m_HeapIndex[cell]);
+	}
+
+	int32_t PathScratch::PopLowest()
+	{
+		const int32_t lowest = m_Heap.front();
+		const int32_t last = m_Heap.back();
+		m_Heap.pop_back();
+
+		if (!m_Heap.empty())
+		{
+			Place(0, last);
+			SiftDown(0);
+		}
+
+		m_HeapIndex[lowest] = ClosedIndex;
+		++m_NumExpanded;
+		return lowest;
+	}
+
+	bool PathScratch::IsLower(int32_t cellA, int32_t cellB) const
+	{
+		if (m_EstimatedTotalCost[cellA] != m_EstimatedTotalCost[cellB])
+			return m_EstimatedTotalCost[cellA] < m_EstimatedTotalCost[cellB];
+
+		//same f, the one further along is closer to the goal
+		if (m_CostSoFar[cellA] != m_CostSoFar[cellB])
+			return m_CostSoFar[cellA] > m_CostSoFar[cellB];
+
+		//xor keeps it a strict order, with a salt of 0 it is the plain index
+		return (static_cast<uint32_t>(cellA) ^ m_TieBreakSalt) < (static_cast<uint32_t>(cellB) ^ m_TieBreakSalt);
+	}
+
+	void PathScratch::SiftUp(int32_t position)
+	{
+		const int32_t cell = m_Heap[position];
+		while (position > 0)
+		{
+			const int32_t parent = (position - 1) / 2;
+			if (!IsLower(cell, m_Heap[parent]))
+				break;
+
+			Place(position, m_Heap[parent]);
+			position = parent;
+		}
+		Place(position, cell);
+	}
+
+	void PathScratch::SiftDown(int32_t position)
+	{
+		const int32_t size = static_cast<int32_t>(m_Heap.size());
+		const int32_t cell = m_Heap[position];
+		while (true)
+		{
+			int32_t child = position * 2 + 1;
+			if (child >= size)
+				break;
+
+			if (child + 1 < size && IsLower(m_Heap[child + 1], m_Heap[child]))
+				++child;
+
+			if (!IsLower(m_Heap[child], cell))
+				break;
+
+			Place(position, m_Heap[child]);
+			position = child;
+		}
+		Place(position, cell);
+	}
+
+	void PathScratch::Place(int32_t position, int32_t cell)
+	{
+		m_Heap[position] = cell;
+		m_HeapIndex[cell] = position;
+	}
+}
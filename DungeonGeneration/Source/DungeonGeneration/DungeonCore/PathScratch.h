@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+namespace DungeonCore
+{
+	//Dense per-cell search state for the grid searches, indexed by cell index.
+	//Nothing is cleared between searches: a cell's entries only count when its stamp matches the current generation.
+	class PathScratch
+	{
+	public:
+		//starts a new search over numCells cells. full ties go to the lower cell index xor tieBreakSalt
+		void BeginSearch(int32_t numCells, uint32_t tieBreakSalt = 0);
+
+		bool IsVisited(int32_t cell) const { return m_Stamps[cell] == m_Generation; }
+		bool IsClosed(int32_t cell) const { return IsVisited(cell) && m_HeapIndex[cell] == ClosedIndex; }
+
+		float GetCostSoFar(int32_t cell) const { return m_CostSoFar[cell]; }
+		int32_t GetParent(int32_t cell) const { return m_Parent[cell]; }
+
+		//records a cheaper way to reach the cell and queues it, or moves it up if it is queued already. the cell must not be closed
+		void Push(int32_t cell, int32_t parent, float costSoFar, float estimatedTotalCost);
+		//removes the open cell with the lowest f-cost and closes it. ties go to the higher g-cost, then to the lower salted index
+		int32_t PopLowest();
+		bool IsOpenEmpty() const { return m_Heap.empty(); }
+		//the f-cost PopLowest would return next, the open list must not be empty
+		float GetLowestEstimate() const { return m_EstimatedTotalCost[m_Heap.front()]; }
+		int32_t GetNumOpen() const { return static_cast<int32_t>(m_Heap.size()); }
+
+		//number of cells closed since BeginSearch
+		int32_t GetNumExpanded() const { return m_NumExpanded; }
+
+	private:
+		static constexpr int32_t ClosedIndex = -1;
+
+		std::vector<uint32_t> m_Stamps;
+		std::vector<float> m_CostSoFar;
+		std::vector<float> m_EstimatedTotalCost;
+		std::vector<int32_t> m_Parent;
+		std::vector<int32_t> m_HeapIndex; //position in m_Heap, or ClosedIndex
+		std::vector<int32_t> m_Heap;      //binary min-heap of open cells
+
+		uint32_t m_Generation = 0;
+		uint32_t m_TieBreakSalt = 0;
+		int32_t m_NumExpanded = 0;
+
+		bool IsLower(int32_t cellA, int32_t cellB) const;
+		void SiftUp(int32_t position);
+		void SiftDown(int32_t position);
+		void Place(int32_t position, int32_t cell);
+	};
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace DungeonCore
+{
+	//The independent streams a 64-bit generation seed is split into. Each stage only draws from its own,
+	//so more or fewer draws in one stage never shift the numbers another stage sees.
+	enum class SeedStream : uint32_t
+	{
+		Placement = 1, //room positions
+		Sizes,         //room widths and depths
+		Loops,         //which non-MST edges come back
+		Corridors      //tie-breaking of the corridor searches
+	};
+
+	//splitmix64 finalizer, turns nearby inputs into unrelated outputs
+	inline uint64_t MixSeed(uint64_t value)
+	{
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+
+	//the 32-bit FRandomStream seed of one stage, only depends on the generation seed and the stage
+	inline int32_t DeriveStreamSeed(uint64_t seed, SeedStream stream)
+	{
+		const uint64_t mixed = MixSeed(MixSeed(seed) + static_cast<uint64_t>(stream));
+		return static_cast<int32_t>(static_cast<uint32_t>(mixed ^ (mixed >> 32)));
+	}
+
+	//Same generator as UE4's FRandomStream, so a seed gives the same dungeon in the editor and headless.
+	class RandomStream
+	{
+	public:
+		RandomStream() {};
+		explicit RandomStream(int32_t seed) { Initialize(seed); }
+		//the stream of one stage of the generation with this seed
+		RandomStream(uint64_t seed, SeedStream stream) { Initialize(DeriveStreamSeed(seed, stream)); }
+
+		void Initialize(int32_t seed)
+		{
+			m_InitialSeed = seed;
+			m_Seed = static_cast<uint32_t>(seed);
+		}
+
+		int32_t GetInitialSeed() const { return m_InitialSeed; }
+
+		//returns a float in [0, 1)
+		float GetFraction()
+		{
+			MutateSeed();
+			const uint32_t bits = 0x3F800000U | (m_Seed >> 9);
+			float result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result - 1.0f;
+		}
+
+		float FRand() { return GetFraction(); }
+
+		//returns all 32 bits of the next state
+		uint32_t GetUnsignedInt()
+		{
+			MutateSeed();
+			return m_Seed;
+		}
+
+		//returns an int in [0, a)
+		int32_t RandHelper(int32_t a)
+		{
+			return (a > 0) ? static_cast<int32_t>(GetFraction() * static_cast<float>(a)) : 0;
+		}
+
+		//returns an int in [min, max]
+		int32_t RandRange(int32_t min, int32_t max)
+		{
+			const int32_t range = (max - min) + 1;
+			return min + RandHelper(range);
+		}
+
+		//returns a float in [min, max)
+		float FRandRange(float min, float max)
+		{
+			return min + (max - min) * FRand();
+		}
+
+	private:
+		void MutateSeed()
+		{
+			m_Seed = (m_Seed * 196314165U) + 907633515U;
+		}
+
+		int32_t m_InitialSeed = 0;
+		uint32_t m_Seed = 0;
+	};
+}
@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomPlacement.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DungeonCore
+{
+	void RoomSpatialHash::Reset(const Grid& grid, float radius)
+	{
+		m_NrColumns = grid.GetNrColumns();
+		m_SquaredRadius = radius * radius;
+
+		//a bucket spans at least the radius, so anything closer than it is in a neighboring bucket
+		m_CellsPerBucketX = std::max(static_cast<int32_t>(std::ceil(radius / grid.GetCellWidth())), 1);
+		m_CellsPerBucketY = std::max(static_cast<int32_t>(std::ceil(radius / grid.GetCellDepth())), 1);
+		m_BucketColumns = (grid.GetNrColumns() + m_CellsPerBucketX - 1) / m_CellsPerBucketX;
+		m_BucketRows = (grid.GetNrRows() + m_CellsPerBucketY - 1) / m_CellsPerBucketY;
+
+		m_BucketHeads.assign(static_cast<size_t>(m_BucketColumns) * m_BucketRows, -1);
+		m_NextRoom.clear();
+		m_Centers.clear();
+	}
+
+	void RoomSpatialHash::Add(const Vec2& center, int32_t cellIndex)
+	{
+		const int32_t bucket = GetBucket(cellIndex);
+		m_NextRoom.push_back(m_BucketHeads[bucket]);
+		m_Centers.push_back(center);
+		m_BucketHeads[bucket] = static_cast<int32_t>(m_Centers.size()) - 1;
+	}
+
+	bool RoomSpatialHash::AnyWithin(const Vec2& center, int32_t cellIndex) const
+	{
+		const int32_t bucketColumn = (cellIndex % m_NrColumns) / m_CellsPerBucketX;
+		const int32_t bucketRow = (cellIndex / m_NrColumns) / m_CellsPerBucketY;
+
+		for (int32_t row = std::max(bucketRow - 1, 0); row <= std::min(bucketRow + 1, m_BucketRows - 1); ++row)
+		{
+			for (int32_t column = std::max(bucketColumn - 1, 0); column <= std::min(bucketColumn + 1, m_BucketColumns - 1); ++column)
+			{
+				for (int32_t room = m_BucketHeads[row * m_BucketColumns + column]; room != -1; room = m_NextRoom[room])
+				{
+					if (DistSquared(center, m_Centers[room]) <= m_SquaredRadius)
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	int32_t RoomSpatialHash::GetBucket(int32_t cellIndex) const
+	{
+		const int32_t bucketColumn = (cellIndex % m_NrColumns) / m_CellsPerBucketX;
+		const int32_t bucketRow = (cellIndex / m_NrColumns) / m_CellsPerBucketY;
+		return bucketRow * m_BucketColumns + bucketColumn;
+	}
+
+	bool PlaceRooms(const GenerationParams& params, Grid& grid, RandomStream& placementStream, RandomStream& sizeStream, std::vector<Room>& outRooms)
+	{
+		RoomSpatialHash spatialHash;
+		return PlaceRooms(params, grid, placementStream, sizeStream, outRooms, spatialHash);
+	}
+
+	namespace
+	{
+		//claims the cell if it is free and clear of every room placed so far
+		bool TryAddRoom(const GenerationParams& params, Grid& grid, RandomStream& sizeStream, int32_t index,
+			std::vector<Room>& outRooms, RoomSpatialHash& spatialHash)
+		{
+			//the hash is small and usually says no, ask it before loading the cell
+			if (spatialHash.AnyWithin(grid.GetCellCenter(index), index))
+				return false;
+
+			if (!grid.IsEmpty(index))
+				return false;
+
+			grid.SetRoom(index);
+			const Vec2 center = grid.GetCellCenter(index);
+			spatialHash.Add(center, index);
+
+			Room room;
+			room.center = center;
+			room.cellIndex = index;
+			room.width = sizeStream.RandRange(params.minRoomSize, params.maxRoomSize);
+			room.depth = sizeStream.RandRange(params.minRoomSize, params.maxRoomSize);
+			outRooms.push_back(room);
+			return true;
+		}
+
+		//Bridson's algorithm. every room placed is active until poissonCandidates spots in the ring
+		//between one and two radii around it are all taken, so each room costs a bounded amount of work
+		bool PlaceRoomsPoissonDisk(const GenerationParams& params, Grid& grid, RandomStream& placementStream, RandomStream& sizeStream, float radius,
+			std::vector<Room>& outRooms, RoomSpatialHash& spatialHash)
+		{
+			const float maxX = grid.GetNrColumns() * grid.GetCellWidth();
+			const float maxY = grid.GetNrRows() * grid.GetCellDepth();
+			const float squaredRadius = radius * radius;
+
+			//first room anywhere
+			const Vec2 firstCenter = Vec2(placementStream.FRandRange(0.f, maxX), placementStream.FRandRange(0.f, maxY));
+			if (params.numberRooms <= 0 || !TryAddRoom(params, grid, sizeStream, grid.GetCellIndex(firstCenter), outRooms, spatialHash))
+				return params.numberRooms <= 0;
+
+			std::vector<int32_t> activeRooms{ 0 };
+			while (!activeRooms.empty() && static_cast<int32_t>(outRooms.size()) < params.numberRooms)
+			{
+				const int32_t activeSlot = placementStream.RandHelper(static_cast<int32_t>(activeRooms.size()));
+				const Vec2 origin = outRooms[activeRooms[activeSlot]].center;
+
+				bool bPlaced = false;
+				for (int32_t candidate{ 0 }; candidate < params.poissonCandidates && !bPlaced; ++candidate)
+				{
+					//a spot in the ring, drawn from its bounding square. no trigonometry, so no libm differences between platforms
+					Vec2 offset;
+					float squaredDistance;
+					do
+					{
+						offset = Vec2(placementStream.FRandRange(-2.f * radius, 2.f * radius), placementStream.FRandRange(-2.f * radius, 2.f * radius));
+						squaredDistance = offset.X * offset.X + offset.Y * offset.Y;
+					} while (squaredDistance < squaredRadius || squaredDistance > 4.f * squaredRadius);
+
+					const Vec2 position = Vec2(origin.X + offset.X, origin.Y + offset.Y);
+					if (position.X < 0.f || position.X >= maxX || position.Y < 0.f || position.Y >= maxY)
+						continue;
+
+					//snapping to the cell center can pull it back inside the radius, the hash check catches that
+					bPlaced = TryAddRoom(params, grid, sizeStream, grid.GetCellIndex(position), outRooms, spatialHash);
+				}
+
+				if (bPlaced)
+				{
+					activeRooms.push_back(static_cast<int32_t>(outRooms.size()) - 1);
+				}
+				else
+				{
+					//nothing fits around this one anymore
+					activeRooms[activeSlot] = activeRooms.back();
+					activeRooms.pop_back();
+				}
+			}
+
+			return static_cast<int32_t>(outRooms.size()) == params.numberRooms;
+		}
+	}
+
+	bool PlaceRooms(const GenerationParams& params, Grid& grid, RandomStream& placementStream, RandomStream& sizeStream, std::vector<Room>& outRooms,
+		RoomSpatialHash& spatialHash)
+	{
+		outRooms.clear();
+		outRooms.reserve(params.numberRooms);
+
+		//a grid that failed to resize has no cell to put a room on
+		if (grid.GetArraySize() == 0)
+			return params.numberRooms <= 0;
+
+		const float maxX = params.nrColumns * params.cellWidth;
+		const float maxY = params.nrRows * params.cellDepth;
+
+		//this circle radius will define an area in which a new dungeon cannot be placed
+		const float circleRadius = params.maxRoomSize + params.roomMargin;
+		spatialHash.Reset(grid, circleRadius);
+
+		if (params.placementMode == PlacementMode::PoissonDisk)
+			return PlaceRoomsPoissonDisk(params, grid, placementStream, sizeStream, circleRadius, outRooms, spatialHash);
+
+		//go over all the number desirable of rooms
+		for (int32_t i{ 0 }; i < params.numberRooms; ++i)
+		{
+			//while overlap is true, run. if not, skip to next index. give up once the room is out of attempts
+			bool bOverlap = false;
+			int32_t attempts = 0;
+			do
+			{
+				if (attempts++ == params.maxPlacementAttempts)
+					return false;
+
+				//random center between the lowest and highest x and y of the grid
+				Vec2 randomCenter = Vec2(placementStream.FRandRange(0.f, maxX), placementStream.FRandRange(0.f, maxY));
+
+				//get a random width and depth
+				int32_t width = sizeStream.RandRange(params.minRoomSize, params.maxRoomSize);
+				int32_t depth = sizeStream.RandRange(params.minRoomSize, params.maxRoomSize);
+
+				//find cell at random center
+				int32_t index = grid.GetCellIndex(randomCenter);
+
+				//new center == cell center
+				Vec2 center = grid.GetCellCenter(index);
+
+				//only rooms placed in this generation can overlap, and only the ones nearby have to be checked
+				bOverlap = !grid.IsEmpty(index) || spatialHash.AnyWithin(center, index);
+
+				if (!bOverlap)
+				{
+					grid.SetRoom(index);
+					spatialHash.Add(center, index);
+
+					Room room;
+					room.center = center;
+					room.cellIndex = index;
+					room.width = width;
+					room.depth = depth;
+					outRooms.push_back(room);
+				}
+
+			} while (bOverlap);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+#include "Grid.h"
+#include "RandomStream.h"
+
+namespace DungeonCore
+{
+	//Buckets of grid cells, each at least as wide as the exclusion radius, holding the rooms whose center cell is inside.
+	//An overlap query only looks at the 3x3 buckets around the candidate instead of every room placed so far.
+	class RoomSpatialHash
+	{
+	public:
+		void Reset(const Grid& grid, float radius);
+		void Add(const Vec2& center, int32_t cellIndex);
+		//true if any added room center is within the radius of center
+		bool AnyWithin(const Vec2& center, int32_t cellIndex) const;
+
+	private:
+		int32_t m_NrColumns = 0;
+		int32_t m_CellsPerBucketX = 1;
+		int32_t m_CellsPerBucketY = 1;
+		int32_t m_BucketColumns = 0;
+		int32_t m_BucketRows = 0;
+		float m_SquaredRadius = 0.f;
+
+		std::vector<int32_t> m_BucketHeads; //first room of each bucket, -1 if empty
+		std::vector<int32_t> m_NextRoom;    //next room in the same bucket, in the order they were added
+		std::vector<Vec2> m_Centers;        //kept here so a query never leaves the hash
+
+		int32_t GetBucket(int32_t cellIndex) const;
+	};
+
+	//Places params.numberRooms rooms on the grid with params.placementMode, marking their center cells full.
+	//Rejection is the body of AC_Generate::SetCells without the meshes, every room gets params.maxPlacementAttempts tries.
+	//PoissonDisk grows the layout outwards from one random room, each room tries params.poissonCandidates spots around itself.
+	//positions are drawn from placementStream and room sizes from sizeStream, so the sizes never move the rooms.
+	//returns false if the rooms didn't all fit, outRooms then holds the ones placed
+	bool PlaceRooms(const GenerationParams& params, Grid& grid, RandomStream& placementStream, RandomStream& sizeStream, std::vector<Room>& outRooms);
+	//same, reusing the caller's hash between generations
+	bool PlaceRooms(const GenerationParams& params, Grid& grid, RandomStream& placementStream, RandomStream& sizeStream, std::vector<Room>& outRooms,
+		RoomSpatialHash& spatialHash);
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Stats.h"
+
+namespace DungeonCore
+{
+	const char* GetStageName(Stage stage)
+	{
+		switch (stage)
+		{
+		case Stage::Placement: return "placement";
+		case Stage::Triangulation: return "triangulation";
+		case Stage::Edges: return "edges";
+		case Stage::Nodes: return "nodes";
+		case Stage::MST: return "mst";
+		case Stage::Loops: return "loops";
+		case Stage::Path: return "path";
+		default: return "unknown";
+		}
+	}
+
+	ScopedStage::ScopedStage(GenerationStats& stats, Stage stage, StatsSink* pSink)
+		: m_Stats(stats[stage]),
+		m_Stage(stage),
+		m_pSink(pSink)
+	{
+		//the sink's own work stays outside the measured time
+		if (m_pSink != nullptr)
+		{
+			m_StartAllocations = m_pSink->GetNumAllocations();
+			m_StartBytes = m_pSink->GetAllocatedBytes();
+			m_pSink->BeginStage(m_Stage);
+		}
+		m_Start = std::chrono::steady_clock::now();
+	}
+
+	ScopedStage::~ScopedStage()
+	{
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_Start;
+		m_Stats.ms += elapsed.count();
+
+		if (m_pSink != nullptr)
+		{
+			m_pSink->EndStage(m_Stage);
+			m_Stats.allocations += m_pSink->GetNumAllocations() - m_StartAllocations;
+			m_Stats.allocatedBytes += m_pSink->GetAllocatedBytes() - m_StartBytes;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DungeonTypes.h"
+
+#include <chrono>
+
+namespace DungeonCore
+{
+	//the stages of one generation, in the order they run
+	enum class Stage : uint8_t
+	{
+		Placement,
+		Triangulation,
+		Edges,
+		Nodes,
+		MST,
+		Loops,
+		Path,
+		Count
+	};
+
+	//short lowercase name, for logs and tool output
+	const char* GetStageName(Stage stage);
+
+	struct StageStats
+	{
+		double ms = 0.0;
+		uint64_t allocations = 0;    //only counted when the sink tracks allocations
+		uint64_t allocatedBytes = 0;
+
+		StageStats& operator+=(const StageStats& other)
+		{
+			ms += other.ms;
+			allocations += other.allocations;
+			allocatedBytes += other.allocatedBytes;
+			return *this;
+		}
+	};
+
+	//wall time and allocations of every stage of the last generation
+	struct GenerationStats
+	{
+		StageStats stages[static_cast<size_t>(Stage::Count)];
+
+		StageStats& operator[](Stage stage) { return stages[static_cast<size_t>(stage)]; }
+		const StageStats& operator[](Stage stage) const { return stages[static_cast<size_t>(stage)]; }
+
+		StageStats Total() const
+		{
+			StageStats total;
+			for (const StageStats& stage : stages)
+			{
+				total += stage;
+			}
+			return total;
+		}
+
+		GenerationStats& operator+=(const GenerationStats& other)
+		{
+			for (size_t i{ 0 }; i < static_cast<size_t>(Stage::Count); ++i)
+			{
+				stages[i] += other.stages[i];
+			}
+			return *this;
+		}
+	};
+
+	//Where the stages get reported. The engine turns them into stat counters and Insights events (see FDungeonStatsSink),
+	//headless tools count their allocations. Every call is optional.
+	class StatsSink
+	{
+	public:
+		virtual ~StatsSink() {};
+
+		virtual void BeginStage(Stage) {};
+		virtual void EndStage(Stage) {};
+
+		//running totals since some fixed point, only the difference over a stage is used. 0 if allocations aren't tracked
+		virtual uint64_t GetNumAllocations() const { return 0; }
+		virtual uint64_t GetAllocatedBytes() const { return 0; }
+	};
+
+	//adds the time and allocations between construction and destruction to one stage of the stats
+	class ScopedStage
+	{
+	public:
+		ScopedStage(GenerationStats& stats, Stage stage, StatsSink* pSink = nullptr);
+		~ScopedStage();
+
+		ScopedStage(const ScopedStage&) = delete;
+		ScopedStage& operator=(const ScopedStage&) = delete;
+
+	private:
+		StageStats& m_Stats;
+		Stage m_Stage;
+		StatsSink* m_pSink;
+		uint64_t m_StartAllocations = 0;
+		uint64_t m_StartBytes = 0;
+		std::chrono::steady_clock::time_point m_Start;
+	};
+}
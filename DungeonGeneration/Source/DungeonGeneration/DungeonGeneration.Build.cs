@@ -12,7 +12,6 @@ public class DungeonGeneration : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 		
-		OptimizeCode = CodeOptimization.Never;
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
 		
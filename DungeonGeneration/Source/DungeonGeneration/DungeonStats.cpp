@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonStats.h"
+#include "HAL/MemoryBase.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DEFINE_STAT(STAT_DungeonPlacement);
+DEFINE_STAT(STAT_DungeonTriangulation);
+DEFINE_STAT(STAT_DungeonEdges);
+DEFINE_STAT(STAT_DungeonNodes);
+DEFINE_STAT(STAT_DungeonMST);
+DEFINE_STAT(STAT_DungeonLoops);
+DEFINE_STAT(STAT_DungeonPath);
+
+namespace
+{
+#if STATS
+	//same order as DungeonCore::Stage
+	TStatId GetStageStatId(DungeonCore::Stage stage)
+	{
+		switch (stage)
+		{
+		case DungeonCore::Stage::Placement: return GET_STATID(STAT_DungeonPlacement);
+		case DungeonCore::Stage::Triangulation: return GET_STATID(STAT_DungeonTriangulation);
+		case DungeonCore::Stage::Edges: return GET_STATID(STAT_DungeonEdges);
+		case DungeonCore::Stage::Nodes: return GET_STATID(STAT_DungeonNodes);
+		case DungeonCore::Stage::MST: return GET_STATID(STAT_DungeonMST);
+		case DungeonCore::Stage::Loops: return GET_STATID(STAT_DungeonLoops);
+		default: return GET_STATID(STAT_DungeonPath);
+		}
+	}
+#endif
+}
+
+void FDungeonStatsSink::BeginStage(DungeonCore::Stage stage)
+{
+#if STATS
+	m_Counters[static_cast<int32>(stage)].Start(GetStageStatId(stage));
+#endif
+#if CPUPROFILERTRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+		FCpuProfilerTrace::OutputBeginDynamicEvent(DungeonCore::GetStageName(stage));
+#endif
+}
+
+void FDungeonStatsSink::EndStage(DungeonCore::Stage stage)
+{
+#if CPUPROFILERTRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+		FCpuProfilerTrace::OutputEndEvent();
+#endif
+#if STATS
+	m_Counters[static_cast<int32>(stage)].Stop();
+#endif
+}
+
+uint64_t FDungeonStatsSink::GetNumAllocations() const
+{
+#if STATS
+	return FMalloc::TotalMallocCalls;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "DungeonCore/Stats.h"
+
+//"stat DungeonGeneration" in the console shows one cycle counter per stage, Unreal Insights gets them as CPU events
+DECLARE_STATS_GROUP(TEXT("DungeonGeneration"), STATGROUP_DungeonGeneration, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placement"), STAT_DungeonPlacement, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangulation"), STAT_DungeonTriangulation, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Edges"), STAT_DungeonEdges, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Nodes"), STAT_DungeonNodes, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MST"), STAT_DungeonMST, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Loops"), STAT_DungeonLoops, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Path"), STAT_DungeonPath, STATGROUP_DungeonGeneration, DUNGEONGENERATION_API);
+
+//Turns the stages of DungeonCore::ScopedStage into the engine's stat counters and trace events.
+//The allocation counts are only an approximation: FMalloc::TotalMallocCalls counts the malloc calls of the whole process, so a stage
+//also picks up whatever the game thread and the other pool threads allocate while it runs. Only tracked in builds with stats.
+//Allocated bytes aren't tracked, the engine allocator keeps no running total of them, so StageStats::allocatedBytes stays 0.
+//Unreal Insights' memory tracks are the place to look for those
+class DUNGEONGENERATION_API FDungeonStatsSink : public DungeonCore::StatsSink
+{
+public:
+	virtual void BeginStage(DungeonCore::Stage stage) override;
+	virtual void EndStage(DungeonCore::Stage stage) override;
+
+	//malloc calls of every thread, see above
+	virtual uint64_t GetNumAllocations() const override;
+	//GetAllocatedBytes is left at the default 0 on purpose
+
+private:
+#if STATS
+	FCycleCounter m_Counters[static_cast<int32>(DungeonCore::Stage::Count)];
+#endif
+};
@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Batch generator: appends a range of seeds to a layout archive, then scans the whole archive through its memory mapping.
+//usage: DungeonBatch --out PATH [--count N] [--seed N] [--rooms N] [--grid N] [--corridor-cost X] [--threads N] [--placement rejection|poisson] [--loops X]
+
+#include "BatchGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace DungeonCore;
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf("usage: DungeonBatch --out PATH [--count N] [--seed N] [--rooms N] [--grid N] [--corridor-cost X] [--threads N] [--placement rejection|poisson] [--loops X]\n");
+		std::printf("  --out    archive to append to, the index goes next to it as PATH.index\n");
+		std::printf("  --count  number of dungeons to generate, 0 only scans the archive (default 10000)\n");
+		std::printf("  --seed   first 64-bit seed, dungeon i uses seed + i (default 0)\n");
+		std::printf("  --rooms  rooms per dungeon (default 20)\n");
+		std::printf("  --grid   cells per side of the square grid (default 100)\n");
+		std::printf("  --corridor-cost  cost of stepping onto an existing corridor, below 1 merges corridors (default 1)\n");
+		std::printf("  --threads  workers, each generates whole dungeons, 0 for one per hardware thread (default 0)\n");
+		std::printf("  --placement  room placement mode (default rejection)\n");
+		std::printf("  --loops  fraction of the non-MST triangulation edges that also get a corridor (default 0)\n");
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string path;
+	uint64_t count = 10000;
+	uint64_t seed = 0;
+	int32_t threads = 0;
+	GenerationParams params;
+	params.numberRooms = 20;
+
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--out") == 0 && hasValue)
+			path = argv[++i];
+		else if (std::strcmp(argv[i], "--count") == 0 && hasValue)
+			count = std::strtoull(argv[++i], nullptr, 0);
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = std::strtoull(argv[++i], nullptr, 0);
+		else if (std::strcmp(argv[i], "--rooms") == 0 && hasValue)
+			params.numberRooms = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--grid") == 0 && hasValue)
+			params.nrRows = params.nrColumns = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--corridor-cost") == 0 && hasValue)
+			params.corridorCostScale = static_cast<float>(std::atof(argv[++i]));
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+			threads = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--loops") == 0 && hasValue)
+			params.loopEdgeRatio = static_cast<float>(std::atof(argv[++i]));
+		else if (std::strcmp(argv[i], "--placement") == 0 && hasValue && std::strcmp(argv[i + 1], "rejection") == 0)
+		{
+			params.placementMode = PlacementMode::Rejection;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--placement") == 0 && hasValue && std::strcmp(argv[i + 1], "poisson") == 0)
+		{
+			params.placementMode = PlacementMode::PoissonDisk;
+			++i;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (path.empty() || params.numberRooms < 3 || params.nrRows <= 0 || static_cast<int64_t>(params.nrRows) * params.nrColumns > Grid::MaxCells
+		|| params.corridorCostScale <= 0.f || params.loopEdgeRatio < 0.f || params.loopEdgeRatio > 1.f || threads < 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (count > 0)
+	{
+		LayoutArchiveWriter writer;
+		if (!writer.Open(path, params))
+		{
+			std::printf("can't open %s for appending, or it holds layouts of other params\n", path.c_str());
+			return 1;
+		}
+
+		ThreadPool pool(threads);
+		BatchGenerator batch(params, &pool);
+		BatchResult result;
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool bWritten = batch.Run(seed, count, writer, result);
+		const bool bClosed = writer.Close();
+		const double seconds = SecondsSince(start);
+		if (!bWritten || !bClosed)
+		{
+			std::printf("writing %s failed after %llu layouts\n", path.c_str(), static_cast<unsigned long long>(result.numLayouts));
+			return 1;
+		}
+
+		std::printf("DungeonBatch: %llu dungeons, %d rooms, %dx%d grid, seeds %llu..%llu, %d workers\n", static_cast<unsigned long long>(count),
+			params.numberRooms, params.nrColumns, params.nrRows, static_cast<unsigned long long>(seed), static_cast<unsigned long long>(seed + count - 1), pool.GetNumWorkers());
+		std::printf("  total            %10.3f s\n", seconds);
+		std::printf("  throughput       %10.1f dungeons/s\n", result.numLayouts / seconds);
+		std::printf("  written          %10.2f MB (%.0f B per dungeon)\n", result.numBytes / (1024.0 * 1024.0), static_cast<double>(result.numBytes) / result.numLayouts);
+	}
+
+	//the scan only touches the pages it reads, the archive is never loaded as a whole
+	LayoutArchive archive;
+	if (!archive.Open(path))
+	{
+		std::printf("can't open %s\n", path.c_str());
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	uint64_t numRooms = 0;
+	uint64_t numMSTEdges = 0;
+	uint64_t numLoopEdges = 0;
+	uint64_t numCorridorCells = 0;
+	uint64_t numCrowded = 0;
+	uint64_t numBroken = 0;
+	int32_t minCorridorCells = 0;
+	int32_t maxCorridorCells = 0;
+	LayoutView view;
+	for (uint64_t i{ 0 }; i < archive.GetNumLayouts(); ++i)
+	{
+		if (!archive.GetLayout(i, view))
+		{
+			++numBroken;
+			continue;
+		}
+
+		const int32_t corridorCells = view.CountCorridorCells();
+		minCorridorCells = numRooms == 0 ? corridorCells : std::min(minCorridorCells, corridorCells);
+		maxCorridorCells = std::max(maxCorridorCells, corridorCells);
+		numCorridorCells += corridorCells;
+		numRooms += view.pHeader->numRooms;
+		numMSTEdges += view.pHeader->numMSTEdges;
+		numLoopEdges += view.pHeader->numLoopEdges;
+		numCrowded += view.AllRoomsPlaced() ? 0 : 1;
+	}
+
+	const uint64_t numRead = archive.GetNumLayouts() - numBroken;
+	const double readCount = static_cast<double>(std::max<uint64_t>(numRead, 1));
+	std::printf("scan of %s:\n", path.c_str());
+	std::printf("  layouts          %10llu (%llu unreadable)\n", static_cast<unsigned long long>(archive.GetNumLayouts()), static_cast<unsigned long long>(numBroken));
+	std::printf("  scan             %10.3f s\n", SecondsSince(start));
+	std::printf("  rooms            %10.1f per dungeon\n", numRooms / readCount);
+	std::printf("  mst edges        %10.1f per dungeon\n", numMSTEdges / readCount);
+	std::printf("  loop edges       %10.1f per dungeon\n", numLoopEdges / readCount);
+	std::printf("  corridor cells   %10.1f per dungeon (min %d, max %d)\n", numCorridorCells / readCount, minCorridorCells, maxCorridorCells);
+	std::printf("  crowded          %10llu dungeons ran out of placement attempts\n", static_cast<unsigned long long>(numCrowded));
+	return numBroken == 0 ? 0 : 1;
+}
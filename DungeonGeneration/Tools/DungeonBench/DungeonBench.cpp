@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Headless benchmark: generates N dungeons with the engine-free core and reports throughput, per-stage timings and allocations and triangulation memory.
+//usage: DungeonBench [--count N] [--rooms N] [--seed N] [--grid N] [--rows N] [--columns N] [--corridor-cost X] [--threads N] [--placement rejection|poisson] [--search astar|jps|hpa|bidir] [--loops X] [--cache DIR] [--max-skew X]
+
+#include "Generator.h"
+#include "LayoutCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace DungeonCore;
+
+namespace
+{
+	//every allocation of the process, the worker threads included
+	std::atomic<uint64_t> g_NumAllocations{ 0 };
+	std::atomic<uint64_t> g_AllocatedBytes{ 0 };
+
+	//hands the global counters to the generator, which keeps the difference over each stage
+	class AllocationCountingSink final : public StatsSink
+	{
+	public:
+		uint64_t GetNumAllocations() const override { return g_NumAllocations.load(std::memory_order_relaxed); }
+		uint64_t GetAllocatedBytes() const override { return g_AllocatedBytes.load(std::memory_order_relaxed); }
+	};
+
+	void PrintUsage()
+	{
+		std::printf("usage: DungeonBench [--count N] [--rooms N] [--seed N] [--grid N] [--rows N] [--columns N] [--corridor-cost X] [--threads N] [--placement rejection|poisson] [--search astar|jps|hpa|bidir] [--loops X] [--cache DIR] [--max-skew X]\n");
+		std::printf("  --count  number of dungeons to generate (default 1000)\n");
+		std::printf("  --rooms  rooms per dungeon (default 20)\n");
+		std::printf("  --seed   first 64-bit seed, dungeon i uses seed + i (default 0)\n");
+		std::printf("  --grid   cells per side of the square grid (default 100)\n");
+		std::printf("  --rows, --columns  one side of the grid, for grids that aren't square\n");
+		std::printf("  --corridor-cost  cost of stepping onto an existing corridor, below 1 merges corridors (default 1)\n");
+		std::printf("  --threads  workers for the corridor searches, 0 for one per hardware thread (default 1)\n");
+		std::printf("  --placement  room placement mode (default rejection)\n");
+		std::printf("  --search  corridor search, jps, hpa and bidir fall back to astar while --corridor-cost is below 1 (default astar)\n");
+		std::printf("  --loops  fraction of the non-MST triangulation edges that also get a corridor (default 0)\n");
+		std::printf("  --cache  layout cache directory, cached seeds are loaded instead of generated and new ones are stored (default none)\n");
+		std::printf("  --max-skew  exit with an error if the mean room center is further than this from the middle of the grid, as a fraction of its side (default none)\n");
+	}
+
+	void PrintStage(const char* name, const StageStats& total, int32_t count)
+	{
+		std::printf("  %-16s %10.4f ms/dungeon %10.1f allocs/dungeon %12.1f B/dungeon\n", name, total.ms / count,
+			static_cast<double>(total.allocations) / count, static_cast<double>(total.allocatedBytes) / count);
+	}
+}
+
+//counted replacement of the global operator new, the array form ends up here too
+void* operator new(std::size_t size)
+{
+	g_NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* pMemory = std::malloc(size > 0 ? size : 1))
+		return pMemory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+int main(int argc, char** argv)
+{
+	int32_t count = 1000;
+	uint64_t seed = 0;
+	int32_t threads = 1;
+	double maxSkew = -1.0;
+	GenerationParams params;
+	params.numberRooms = 20;
+	LayoutCache cache;
+
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--count") == 0 && hasValue)
+			count = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--rooms") == 0 && hasValue)
+			params.numberRooms = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = std::strtoull(argv[++i], nullptr, 0);
+		else if (std::strcmp(argv[i], "--grid") == 0 && hasValue)
+			params.nrRows = params.nrColumns = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--rows") == 0 && hasValue)
+			params.nrRows = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--columns") == 0 && hasValue)
+			params.nrColumns = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--max-skew") == 0 && hasValue)
+			maxSkew = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--corridor-cost") == 0 && hasValue)
+			params.corridorCostScale = static_cast<float>(std::atof(argv[++i]));
+		else if (std::strcmp(argv[i], "--loops") == 0 && hasValue)
+			params.loopEdgeRatio = static_cast<float>(std::atof(argv[++i]));
+		else if (std::strcmp(argv[i], "--cache") == 0 && hasValue)
+			cache.SetDirectory(argv[++i]);
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+			threads = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--placement") == 0 && hasValue && std::strcmp(argv[i + 1], "rejection") == 0)
+		{
+			params.placementMode = PlacementMode::Rejection;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--placement") == 0 && hasValue && std::strcmp(argv[i + 1], "poisson") == 0)
+		{
+			params.placementMode = PlacementMode::PoissonDisk;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--search") == 0 && hasValue && std::strcmp(argv[i + 1], "astar") == 0)
+		{
+			params.corridorSearch = PathSearch::AStar;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--search") == 0 && hasValue && std::strcmp(argv[i + 1], "jps") == 0)
+		{
+			params.corridorSearch = PathSearch::JumpPoint;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--search") == 0 && hasValue && std::strcmp(argv[i + 1], "hpa") == 0)
+		{
+			params.corridorSearch = PathSearch::Hierarchical;
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--search") == 0 && hasValue && std::strcmp(argv[i + 1], "bidir") == 0)
+		{
+			params.corridorSearch = PathSearch::Bidirectional;
+			++i;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (count <= 0 || params.numberRooms < 3 || params.nrRows <= 0 || params.nrColumns <= 0 || static_cast<int64_t>(params.nrRows) * params.nrColumns > Grid::MaxCells
+		|| params.corridorCostScale <= 0.f || params.loopEdgeRatio < 0.f || params.loopEdgeRatio > 1.f || threads < 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Generator generator(params);
+	ThreadPool pool(threads);
+	if (pool.GetNumWorkers() > 1)
+		generator.SetExecutor(&pool);
+	AllocationCountingSink allocationSink;
+	generator.SetStatsSink(&allocationSink);
+	GenerationStats totals;
+	size_t corridorCells = 0;
+	size_t uniqueCorridorCells = 0;
+	int32_t crowdedDungeons = 0;
+	int32_t cacheHits = 0;
+	LayoutView cachedLayout;
+	//sum of the room centers over the grid size, the mean is about 0.5 on both axes when the rooms cover the whole grid
+	double spreadX = 0.0;
+	double spreadY = 0.0;
+	size_t numRooms = 0;
+	const double gridWidth = params.nrColumns * params.cellWidth;
+	const double gridDepth = params.nrRows * params.cellDepth;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int32_t i{ 0 }; i < count; ++i)
+	{
+		//a hit is the whole dungeon, straight from the mapped file
+		if (cache.Find(params, seed + static_cast<uint64_t>(i), cachedLayout))
+		{
+			++cacheHits;
+			uniqueCorridorCells += cachedLayout.CountCorridorCells();
+			for (int32_t room{ 0 }; room < cachedLayout.pHeader->numRooms; ++room)
+			{
+				spreadX += cachedLayout.pRooms[room].centerX / gridWidth;
+				spreadY += cachedLayout.pRooms[room].centerY / gridDepth;
+			}
+			numRooms += cachedLayout.pHeader->numRooms;
+			if (!cachedLayout.AllRoomsPlaced())
+				++crowdedDungeons;
+			continue;
+		}
+
+		const DungeonLayout& layout = generator.Generate(seed + static_cast<uint64_t>(i));
+		totals += generator.GetStats();
+		if (!cache.GetDirectory().empty())
+			cache.Store(params, layout.seed, layout.rooms, layout.allRoomsPlaced, generator.GetGraph(), generator.GetGrid());
+		uniqueCorridorCells += generator.GetGrid().GetNumCorridorCells();
+		for (const Room& room : layout.rooms)
+		{
+			spreadX += room.center.X / gridWidth;
+			spreadY += room.center.Y / gridDepth;
+		}
+		numRooms += layout.rooms.size();
+		if (!layout.allRoomsPlaced)
+			++crowdedDungeons;
+
+		for (const std::vector<int32_t>& corridor : layout.corridors)
+		{
+			corridorCells += corridor.size();
+		}
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::printf("DungeonBench: %d dungeons, %d rooms, %dx%d grid, seeds %llu..%llu, %d workers\n", count, params.numberRooms, params.nrColumns, params.nrRows,
+		static_cast<unsigned long long>(seed), static_cast<unsigned long long>(seed + count - 1), pool.GetNumWorkers());
+	std::printf("  total            %10.3f s\n", elapsed.count());
+	std::printf("  throughput       %10.1f dungeons/s\n", count / elapsed.count());
+	//the corridor paths and stage times only exist for the dungeons that were generated
+	const int32_t generated = count - cacheHits;
+	std::printf("  visible cells    %10.1f per dungeon (unique corridor cells)\n", static_cast<double>(uniqueCorridorCells) / count);
+	std::printf("  crowded          %10d dungeons ran out of placement attempts\n", crowdedDungeons);
+	const double meanX = numRooms > 0 ? spreadX / numRooms : 0.5;
+	const double meanY = numRooms > 0 ? spreadY / numRooms : 0.5;
+	std::printf("  room spread      %10.3f x %.3f (mean room center over the grid size)\n", meanX, meanY);
+	const double skew = std::max(std::abs(meanX - 0.5), std::abs(meanY - 0.5));
+	if (maxSkew >= 0.0 && skew > maxSkew)
+	{
+		std::printf("the rooms are skewed by %.3f, more than --max-skew %.3f\n", skew, maxSkew);
+		return 1;
+	}
+	if (!cache.GetDirectory().empty())
+		std::printf("  cache            %10d hits, %d generated and stored in %s\n", cacheHits, generated, cache.GetDirectory().c_str());
+	if (generated == 0)
+		return 0;
+
+	std::printf("  corridor cells   %10.1f per generated dungeon\n", static_cast<double>(corridorCells) / generated);
+	std::printf("stages:\n");
+	for (size_t i{ 0 }; i < static_cast<size_t>(Stage::Count); ++i)
+	{
+		const Stage stage = static_cast<Stage>(i);
+		PrintStage(GetStageName(stage), totals[stage], generated);
+	}
+	PrintStage("total", totals.Total(), generated);
+
+	//the mesh and the triangle array are reused, so the last dungeon holds the capacity of the biggest one
+	const Graph& graph = generator.GetGraph();
+	const size_t numTriangles = graph.GetTriangles().size();
+	std::printf("memory:\n");
+	std::printf("  triangle         %10zu B (+ %zu B mesh slot)\n", sizeof(Triangle), sizeof(MeshTriangle));
+	std::printf("  edge             %10zu B\n", sizeof(TriangulationEdge));
+	if (numTriangles > 0)
+		std::printf("  triangulation    %10.1f B/triangle held\n", static_cast<double>(graph.GetTriangulationBytes()) / numTriangles);
+	const Grid& grid = generator.GetGrid();
+	std::printf("  grid             %10.2f B/cell (%d cells)\n", static_cast<double>(grid.GetStorageBytes()) / grid.GetArraySize(), grid.GetArraySize());
+	return 0;
+}
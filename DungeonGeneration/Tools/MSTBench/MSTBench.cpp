@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Headless MST benchmark: triangulates uniform random points and times Kruskal with the comparison sort against the radix sort.
+//usage: MSTBench [--repeat N] [--seed N] [--points N]...
+
+#include "Graph.h"
+#include "RandomStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace DungeonCore;
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf("usage: MSTBench [--repeat N] [--seed N] [--points N]...\n");
+		std::printf("  --repeat  MST runs per point count and sort, the average is reported (default 20)\n");
+		std::printf("  --seed    seed of the random points (default 0)\n");
+		std::printf("  --points  number of points, can be given several times (default 1000 10000 100000)\n");
+	}
+
+	//average ms of one MST over repeat runs, the triangulation edges are already there
+	double TimeMST(Graph& graph, EdgeSort sort, int32_t repeat)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int32_t i{ 0 }; i < repeat; ++i)
+		{
+			graph.FindMinimumSpanningTree(sort);
+		}
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / repeat;
+	}
+
+	double TreeLength(const Graph& graph)
+	{
+		double length = 0.0;
+		for (const TriangulationEdge& edge : graph.GetMSTEdges())
+		{
+			length += edge.cost;
+		}
+		return length;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int32_t repeat = 20;
+	int32_t seed = 0;
+	std::vector<int32_t> pointCounts;
+
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--repeat") == 0 && hasValue)
+			repeat = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--points") == 0 && hasValue)
+			pointCounts.push_back(std::atoi(argv[++i]));
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (pointCounts.empty())
+		pointCounts = { 1000, 10000, 100000 };
+
+	for (int32_t numPoints : pointCounts)
+	{
+		if (numPoints < 2 || repeat <= 0)
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	std::printf("MSTBench: seed %d, %d runs per sort\n", seed, repeat);
+	std::printf("  %10s %10s %14s %14s %8s\n", "points", "edges", "comparison ms", "radix ms", "speedup");
+
+	Graph graph;
+	for (int32_t numPoints : pointCounts)
+	{
+		//spread the points over a square that keeps the density the same for every count
+		RandomStream rs(seed);
+		const float side = 100.f * std::sqrt(static_cast<float>(numPoints));
+		graph.DeletePoints();
+		for (int32_t i{ 0 }; i < numPoints; ++i)
+		{
+			graph.AddPoint(Vec2(rs.FRandRange(0.f, side), rs.FRandRange(0.f, side)));
+		}
+		graph.TriangulationAlgorithm();
+		graph.GetEdges();
+
+		const double comparisonMs = TimeMST(graph, EdgeSort::Comparison, repeat);
+		const std::vector<TriangulationEdge> comparisonTree = graph.GetMSTEdges();
+		const double radixMs = TimeMST(graph, EdgeSort::Radix, repeat);
+
+		//same tie breaking, so not just the length but the edges themselves have to match
+		if (!(comparisonTree.size() == graph.GetMSTEdges().size() && std::equal(comparisonTree.begin(), comparisonTree.end(), graph.GetMSTEdges().begin())))
+		{
+			std::printf("  %10d the two sorts built different trees\n", numPoints);
+			return 1;
+		}
+
+		std::printf("  %10d %10zu %14.3f %14.3f %7.2fx   (tree length %.1f)\n", numPoints, graph.GetTriangulationEdges().size(), comparisonMs, radixMs, comparisonMs / radixMs, TreeLength(graph));
+	}
+	return 0;
+}
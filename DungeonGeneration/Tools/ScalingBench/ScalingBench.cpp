@@ -0,0 +1,647 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Scaling benchmark: times the triangulation, the MST and the grid searches over growing inputs and point distributions,
+//then fits the exponent k of time ~ n^k for each of them, so a change in how a stage scales shows up and not only its constant.
+//--verify instead checks the paths of the grid searches against A* on randomized grids, and fails if one is off.
+//usage: ScalingBench [--suite NAME]... [--dist NAME]... [--points N]... [--grid N]... [--repeat N] [--seed N] [--fit-from N] [--max-exponent X] [--json PATH] [--verify]
+
+#include "Graph.h"
+#include "Grid.h"
+#include "RandomStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace DungeonCore;
+
+namespace
+{
+	enum class Suite : uint8_t
+	{
+		Triangulation,
+		MST,
+		AStar,
+		JumpPoint,
+		Hierarchical,
+		Bidirectional
+	};
+
+	enum class Distribution : uint8_t
+	{
+		Uniform,   //random over the whole square
+		Clustered, //a few tight blobs, long empty gaps between them
+		Collinear, //all on one line, the degenerate case of the triangulation
+		Grid       //distinct cell centers, like the rooms SetCells snaps to the grid
+	};
+
+	const char* const SuiteNames[] = { "triangulation", "mst", "astar", "jps", "hpa", "bidir" };
+	const char* const DistributionNames[] = { "uniform", "clustered", "collinear", "grid" };
+
+	//one timed size of one suite and distribution
+	struct Result
+	{
+		Suite suite;
+		Distribution distribution;
+		int64_t n = 0;              //points, or cells for the grid searches
+		double ms = 0.0;            //median of the runs, one call (one query for the grid searches)
+		double expansions = 0.0;    //cells closed per query, grid searches only
+	};
+
+	//least squares line through (log n, log ms)
+	struct Fit
+	{
+		Suite suite;
+		Distribution distribution;
+		int32_t numSizes = 0;
+		double exponent = 0.0;
+		double r2 = 0.0;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("usage: ScalingBench [--suite NAME]... [--dist NAME]... [--points N]... [--grid N]... [--repeat N] [--seed N] [--fit-from N] [--max-exponent X] [--json PATH] [--verify]\n");
+		std::printf("  --suite  triangulation, mst, astar, jps, hpa or bidir, can be given several times (default all)\n");
+		std::printf("  --dist   uniform, clustered, collinear or grid, can be given several times (default all)\n");
+		std::printf("  --points point counts of the triangulation and mst suites (default 10 100 1000 10000 100000)\n");
+		std::printf("  --grid   cells per side of the grid search suites (default 100 256 512 1024 2048 4096)\n");
+		std::printf("  --repeat timed runs per size, the median is kept (default 5)\n");
+		std::printf("  --seed   seed of the points and query endpoints (default 0)\n");
+		std::printf("  --fit-from  smallest n used for the fits, below it the fixed costs hide the growth (default 1000)\n");
+		std::printf("  --max-exponent  exit with an error if any fitted exponent is above this (default none)\n");
+		std::printf("  --json   also write the results and fits to this file\n");
+		std::printf("  --verify check the grid suites against astar on randomized grids instead of timing anything, exit with an error on a mismatch\n");
+	}
+
+	template <typename Enum, size_t N>
+	bool ParseName(const char* const (&names)[N], const char* text, std::vector<Enum>& outValues)
+	{
+		for (size_t i{ 0 }; i < N; ++i)
+		{
+			if (std::strcmp(names[i], text) == 0)
+			{
+				outValues.push_back(static_cast<Enum>(i));
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//numPoints points in [0, side)^2. the same seed gives the same points on every platform
+	void MakePoints(Distribution distribution, int32_t numPoints, float side, RandomStream& rs, std::vector<Vec2>& outPoints)
+	{
+		outPoints.clear();
+		outPoints.reserve(numPoints);
+
+		switch (distribution)
+		{
+		case Distribution::Uniform:
+			for (int32_t i{ 0 }; i < numPoints; ++i)
+			{
+				outPoints.push_back(Vec2(rs.FRandRange(0.f, side), rs.FRandRange(0.f, side)));
+			}
+			break;
+
+		case Distribution::Clustered:
+		{
+			//about sqrt(n) / 4 clusters but at least 4, each a twentieth of the side across
+			const int32_t numClusters = std::max(4, static_cast<int32_t>(std::sqrt(static_cast<float>(numPoints)) / 4));
+			const float radius = side / 40.f;
+			std::vector<Vec2> centers;
+			for (int32_t i{ 0 }; i < numClusters; ++i)
+			{
+				centers.push_back(Vec2(rs.FRandRange(radius, side - radius), rs.FRandRange(radius, side - radius)));
+			}
+			for (int32_t i{ 0 }; i < numPoints; ++i)
+			{
+				//sum of two uniforms, denser in the middle of the cluster
+				const Vec2& center = centers[rs.RandHelper(numClusters)];
+				const float x = (rs.FRand() + rs.FRand() - 1.f) * radius;
+				const float y = (rs.FRand() + rs.FRand() - 1.f) * radius;
+				outPoints.push_back(Vec2(center.X + x, center.Y + y));
+			}
+			break;
+		}
+
+		case Distribution::Collinear:
+			for (int32_t i{ 0 }; i < numPoints; ++i)
+			{
+				outPoints.push_back(Vec2(rs.FRandRange(0.f, side), side / 2.f));
+			}
+			break;
+
+		case Distribution::Grid:
+		{
+			//distinct cells of a lattice with four cells per point, picked by selection sampling
+			const int32_t cellsPerSide = static_cast<int32_t>(std::ceil(std::sqrt(4.0 * numPoints)));
+			const int32_t numCells = cellsPerSide * cellsPerSide;
+			const float cellSize = side / cellsPerSide;
+			int32_t numNeeded = numPoints;
+			for (int32_t cell{ 0 }; cell < numCells && numNeeded > 0; ++cell)
+			{
+				if (rs.RandHelper(numCells - cell) < numNeeded)
+				{
+					outPoints.push_back(Vec2((cell % cellsPerSide + 0.5f) * cellSize, (cell / cellsPerSide + 0.5f) * cellSize));
+					--numNeeded;
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	double Median(std::vector<double>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples[samples.size() / 2];
+	}
+
+	//median ms of one call to run. small inputs are looped until a sample is at least a millisecond
+	template <typename Function>
+	double TimeMedian(int32_t repeat, Function run)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		auto start = Clock::now();
+		run();
+		const std::chrono::duration<double, std::milli> first = Clock::now() - start;
+		const int32_t callsPerSample = first.count() >= 1.0 ? 1 : std::min(100000, static_cast<int32_t>(1.0 / std::max(first.count(), 1e-5)) + 1);
+
+		std::vector<double> samples;
+		for (int32_t i{ 0 }; i < repeat; ++i)
+		{
+			start = Clock::now();
+			for (int32_t call{ 0 }; call < callsPerSample; ++call)
+			{
+				run();
+			}
+			const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+			samples.push_back(elapsed.count() / callsPerSample);
+		}
+		return Median(samples);
+	}
+
+	void RunGraphSuites(const std::vector<Suite>& suites, Distribution distribution, const std::vector<int32_t>& pointCounts,
+		int32_t repeat, int32_t seed, std::vector<Result>& outResults)
+	{
+		const bool bTriangulation = std::find(suites.begin(), suites.end(), Suite::Triangulation) != suites.end();
+		const bool bMST = std::find(suites.begin(), suites.end(), Suite::MST) != suites.end();
+
+		Graph graph;
+		std::vector<Vec2> points;
+		for (int32_t numPoints : pointCounts)
+		{
+			//same density for every count, one room-sized spacing between points
+			RandomStream rs(seed);
+			MakePoints(distribution, numPoints, 100.f * std::sqrt(static_cast<float>(numPoints)), rs, points);
+			graph.SetPointsArray(points);
+
+			if (bTriangulation)
+			{
+				const double ms = TimeMedian(repeat, [&graph]() { graph.TriangulationAlgorithm(); });
+				outResults.push_back({ Suite::Triangulation, distribution, numPoints, ms, 0.0 });
+			}
+			else
+			{
+				graph.TriangulationAlgorithm();
+			}
+
+			if (bMST)
+			{
+				graph.GetEdges();
+				const double ms = TimeMedian(repeat, [&graph]() { graph.FindMinimumSpanningTree(); });
+				outResults.push_back({ Suite::MST, distribution, numPoints, ms, 0.0 });
+			}
+		}
+	}
+
+	bool IsGridSuite(Suite suite)
+	{
+		return suite == Suite::AStar || suite == Suite::JumpPoint || suite == Suite::Hierarchical || suite == Suite::Bidirectional;
+	}
+
+	//the corridor search of a grid suite
+	PathSearch GetPathSearch(Suite suite)
+	{
+		switch (suite)
+		{
+		case Suite::JumpPoint: return PathSearch::JumpPoint;
+		case Suite::Hierarchical: return PathSearch::Hierarchical;
+		case Suite::Bidirectional: return PathSearch::Bidirectional;
+		default: return PathSearch::AStar;
+		}
+	}
+
+	//one query of a grid suite, returns the cells (or abstract nodes) it closed. bidir closes cells in both scratches
+	int32_t FindGridPath(Suite suite, const Grid& grid, int32_t startIndex, int32_t endIndex, std::vector<int32_t>& outPath, PathScratch& scratch,
+		PathScratch& backwardScratch, HierarchicalScratch& hierarchicalScratch)
+	{
+		switch (suite)
+		{
+		case Suite::JumpPoint:
+			grid.JumpPointPath(startIndex, endIndex, outPath, scratch);
+			return scratch.GetNumExpanded();
+		case Suite::Hierarchical:
+			grid.HierarchicalPath(startIndex, endIndex, outPath, scratch, hierarchicalScratch);
+			return hierarchicalScratch.numExpanded;
+		case Suite::Bidirectional:
+			grid.BidirectionalPath(startIndex, endIndex, outPath, scratch, backwardScratch);
+			return scratch.GetNumExpanded() + backwardScratch.GetNumExpanded();
+		default:
+			grid.AStarPath(startIndex, endIndex, outPath, scratch);
+			return scratch.GetNumExpanded();
+		}
+	}
+
+	void RunGridSuite(Suite suite, Distribution distribution, const std::vector<int32_t>& gridSides, int32_t repeat, int32_t seed, std::vector<Result>& outResults)
+	{
+		//the queries run between consecutive endpoints drawn from the distribution, so their length grows with the grid
+		constexpr int32_t numQueries = 32;
+
+		std::vector<Vec2> endpoints;
+		std::vector<int32_t> path;
+		PathScratch scratch;
+		PathScratch backwardScratch;
+		HierarchicalScratch hierarchicalScratch;
+		for (int32_t side : gridSides)
+		{
+			//the abstract graph is built once per grid, outside the timed queries
+			Grid grid(side, side);
+			if (suite == Suite::Hierarchical)
+				grid.UpdateHierarchy();
+			RandomStream rs(seed);
+			MakePoints(distribution, numQueries + 1, side * grid.GetCellWidth(), rs, endpoints);
+
+			std::vector<int32_t> cells;
+			for (const Vec2& endpoint : endpoints)
+			{
+				cells.push_back(grid.GetCellIndex(endpoint));
+			}
+
+			//the expansions don't change between runs, count them once
+			double expansions = 0.0;
+			const int32_t numCells = static_cast<int32_t>(cells.size());
+			for (int32_t i{ 1 }; i < numCells; ++i)
+			{
+				expansions += FindGridPath(suite, grid, cells[i - 1], cells[i], path, scratch, backwardScratch, hierarchicalScratch);
+			}
+
+			const double ms = TimeMedian(repeat, [&]()
+				{
+					for (int32_t i{ 1 }; i < numCells; ++i)
+					{
+						FindGridPath(suite, grid, cells[i - 1], cells[i], path, scratch, backwardScratch, hierarchicalScratch);
+					}
+				});
+			outResults.push_back({ suite, distribution, static_cast<int64_t>(side) * side, ms / (numCells - 1), expansions / (numCells - 1) });
+		}
+	}
+
+	//the paths of one grid suite over every query of --verify
+	struct VerifyResult
+	{
+		int32_t numQueries = 0;
+		int32_t numFailures = 0;
+		double cost = 0.0;          //summed over the queries with a path
+		double referenceCost = 0.0; //A* on the same queries
+	};
+
+	//the cost of the cells a path steps onto, or -1 if it isn't a path from startIndex to endIndex:
+	//four-neighbor steps only, and no blocked cell after the start
+	double GetPathCost(const Grid& grid, const std::vector<int32_t>& path, int32_t startIndex, int32_t endIndex)
+	{
+		if (path.empty() || path.front() != startIndex || path.back() != endIndex)
+			return -1.0;
+
+		const int32_t columns = grid.GetNrColumns();
+		double cost = 0.0;
+		for (size_t i{ 1 }; i < path.size(); ++i)
+		{
+			const int32_t step = std::abs(path[i] - path[i - 1]);
+			const bool bNeighbor = step == columns || (step == 1 && path[i] / columns == path[i - 1] / columns);
+			if (!bNeighbor || grid.IsBlocked(path[i]))
+				return -1.0;
+			cost += grid.GetCellCost(path[i]);
+		}
+		return cost;
+	}
+
+	//walls on a random share of the cells and, on half of the grids, weights of 2 to 5 on some of the others
+	void AddRandomCosts(Grid& grid, RandomStream& rs)
+	{
+		const float wallChance = 0.1f * rs.RandHelper(4);
+		const bool bWeighted = rs.RandHelper(2) == 1;
+		for (int32_t index{ 0 }; index < grid.GetArraySize(); ++index)
+		{
+			if (rs.FRand() < wallChance)
+				grid.SetCellCost(index, Grid::BlockedCost);
+			else if (bWeighted && rs.RandHelper(5) == 0)
+				grid.SetCellCost(index, static_cast<float>(rs.RandRange(2, 5)));
+		}
+	}
+
+	//routes random requests through Grid::FindPaths with the suite's PathSearch, so the dispatch is checked along with the search,
+	//and compares every path with Grid::AStarPath: same cost for the exact searches (jps, bidir), never cheaper for hpa
+	VerifyResult VerifyGridSuite(Suite suite, int32_t seed)
+	{
+		constexpr int32_t numGrids = 300;
+		constexpr int32_t numRequests = 20;
+
+		VerifyResult result;
+		RandomStream rs(seed);
+		std::vector<PathRequest> requests;
+		std::vector<std::vector<int32_t>> paths;
+		std::vector<int32_t> referencePath;
+		PathScratch scratch;
+		for (int32_t gridIndex{ 0 }; gridIndex < numGrids; ++gridIndex)
+		{
+			//drawn one at a time, the order function arguments are evaluated in is unspecified
+			const int32_t nrRows = rs.RandRange(2, 96);
+			const int32_t nrColumns = rs.RandRange(2, 96);
+			Grid grid(nrRows, nrColumns);
+			AddRandomCosts(grid, rs);
+
+			requests.clear();
+			for (int32_t i{ 0 }; i < numRequests; ++i)
+			{
+				requests.push_back({ rs.RandHelper(grid.GetArraySize()), rs.RandHelper(grid.GetArraySize()), rs.GetUnsignedInt() });
+			}
+
+			grid.SetPathSearch(GetPathSearch(suite));
+			grid.FindPaths(requests, 1.f, paths);
+
+			for (size_t i{ 0 }; i < requests.size(); ++i)
+			{
+				++result.numQueries;
+				const PathRequest& request = requests[i];
+				if (!grid.AStarPath(request.start, request.end, referencePath, scratch))
+				{
+					if (!paths[i].empty())
+						++result.numFailures;
+					continue;
+				}
+
+				//hpa may miss the shortest path, not find a shorter one
+				const double referenceCost = GetPathCost(grid, referencePath, request.start, request.end);
+				const double cost = GetPathCost(grid, paths[i], request.start, request.end);
+				const bool bCostMatches = suite == Suite::Hierarchical ? cost >= referenceCost : cost == referenceCost;
+				if (referenceCost < 0.0 || cost < 0.0 || !bCostMatches)
+				{
+					++result.numFailures;
+					continue;
+				}
+				result.cost += cost;
+				result.referenceCost += referenceCost;
+			}
+		}
+		return result;
+	}
+
+	//edits the costs of a grid whose hierarchy is built and updates it, then checks the paths against a hierarchy built from
+	//scratch on a copy of the edited grid. the clusters the edits didn't touch are kept, so both have to come out the same
+	VerifyResult VerifyHierarchyUpdates(int32_t seed)
+	{
+		constexpr int32_t numGrids = 100;
+		constexpr int32_t numRequests = 20;
+
+		VerifyResult result;
+		RandomStream rs(seed);
+		std::vector<int32_t> path;
+		std::vector<int32_t> freshPath;
+		PathScratch scratch;
+		HierarchicalScratch hierarchicalScratch;
+		for (int32_t gridIndex{ 0 }; gridIndex < numGrids; ++gridIndex)
+		{
+			const int32_t nrRows = rs.RandRange(2, 96);
+			const int32_t nrColumns = rs.RandRange(2, 96);
+			Grid grid(nrRows, nrColumns);
+			AddRandomCosts(grid, rs);
+			grid.UpdateHierarchy();
+
+			const int32_t numEdits = rs.RandRange(1, 50);
+			for (int32_t i{ 0 }; i < numEdits; ++i)
+			{
+				const int32_t index = rs.RandHelper(grid.GetArraySize());
+				const int32_t kind = rs.RandHelper(3);
+				grid.SetCellCost(index, kind == 0 ? Grid::BlockedCost : kind == 1 ? 1.f : static_cast<float>(rs.RandRange(2, 5)));
+			}
+			grid.UpdateHierarchy();
+
+			Grid freshGrid(nrRows, nrColumns);
+			freshGrid.CopyCellCosts(grid);
+			freshGrid.UpdateHierarchy();
+
+			for (int32_t i{ 0 }; i < numRequests; ++i)
+			{
+				++result.numQueries;
+				const int32_t startIndex = rs.RandHelper(grid.GetArraySize());
+				const int32_t endIndex = rs.RandHelper(grid.GetArraySize());
+				const bool bFound = grid.HierarchicalPath(startIndex, endIndex, path, scratch, hierarchicalScratch);
+				const bool bFreshFound = freshGrid.HierarchicalPath(startIndex, endIndex, freshPath, scratch, hierarchicalScratch);
+				if (bFound != bFreshFound || path != freshPath)
+					++result.numFailures;
+			}
+		}
+		return result;
+	}
+
+	void FitExponents(const std::vector<Result>& results, int64_t fitFrom, std::vector<Fit>& outFits)
+	{
+		for (size_t suite{ 0 }; suite < sizeof(SuiteNames) / sizeof(SuiteNames[0]); ++suite)
+		{
+			for (size_t distribution{ 0 }; distribution < 4; ++distribution)
+			{
+				double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0, sumYY = 0.0;
+				int32_t count = 0;
+				for (const Result& result : results)
+				{
+					if (static_cast<size_t>(result.suite) != suite || static_cast<size_t>(result.distribution) != distribution || result.n < fitFrom || result.ms <= 0.0)
+						continue;
+
+					const double x = std::log(static_cast<double>(result.n));
+					const double y = std::log(result.ms);
+					sumX += x;
+					sumY += y;
+					sumXX += x * x;
+					sumXY += x * y;
+					sumYY += y * y;
+					++count;
+				}
+				if (count < 2)
+					continue;
+
+				const double varX = count * sumXX - sumX * sumX;
+				const double varY = count * sumYY - sumY * sumY;
+				const double covXY = count * sumXY - sumX * sumY;
+				Fit fit{ static_cast<Suite>(suite), static_cast<Distribution>(distribution), count };
+				fit.exponent = covXY / varX;
+				fit.r2 = varY > 0.0 ? (covXY * covXY) / (varX * varY) : 1.0;
+				outFits.push_back(fit);
+			}
+		}
+	}
+
+	bool WriteJson(const std::string& path, int32_t seed, int32_t repeat, int64_t fitFrom, const std::vector<Result>& results, const std::vector<Fit>& fits)
+	{
+		FILE* pFile = std::fopen(path.c_str(), "w");
+		if (pFile == nullptr)
+			return false;
+
+		std::fprintf(pFile, "{\n  \"seed\": %d,\n  \"repeat\": %d,\n  \"fitFrom\": %lld,\n  \"results\": [\n", seed, repeat, static_cast<long long>(fitFrom));
+		for (size_t i{ 0 }; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			std::fprintf(pFile, "    {\"suite\": \"%s\", \"distribution\": \"%s\", \"n\": %lld, \"ms\": %.6g",
+				SuiteNames[static_cast<size_t>(result.suite)], DistributionNames[static_cast<size_t>(result.distribution)], static_cast<long long>(result.n), result.ms);
+			if (IsGridSuite(result.suite))
+				std::fprintf(pFile, ", \"expansions\": %.6g", result.expansions);
+			std::fprintf(pFile, "}%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(pFile, "  ],\n  \"fits\": [\n");
+		for (size_t i{ 0 }; i < fits.size(); ++i)
+		{
+			const Fit& fit = fits[i];
+			std::fprintf(pFile, "    {\"suite\": \"%s\", \"distribution\": \"%s\", \"sizes\": %d, \"exponent\": %.4f, \"r2\": %.4f}%s\n",
+				SuiteNames[static_cast<size_t>(fit.suite)], DistributionNames[static_cast<size_t>(fit.distribution)], fit.numSizes, fit.exponent, fit.r2,
+				i + 1 < fits.size() ? "," : "");
+		}
+		std::fprintf(pFile, "  ]\n}\n");
+		return std::fclose(pFile) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<Suite> suites;
+	std::vector<Distribution> distributions;
+	std::vector<int32_t> pointCounts;
+	std::vector<int32_t> gridSides;
+	int32_t repeat = 5;
+	int32_t seed = 0;
+	int64_t fitFrom = 1000;
+	double maxExponent = 0.0;
+	std::string jsonPath;
+	bool bVerify = false;
+
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--suite") == 0 && hasValue && ParseName(SuiteNames, argv[i + 1], suites))
+			++i;
+		else if (std::strcmp(argv[i], "--dist") == 0 && hasValue && ParseName(DistributionNames, argv[i + 1], distributions))
+			++i;
+		else if (std::strcmp(argv[i], "--points") == 0 && hasValue)
+			pointCounts.push_back(std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--grid") == 0 && hasValue)
+			gridSides.push_back(std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue)
+			repeat = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--fit-from") == 0 && hasValue)
+			fitFrom = std::atoll(argv[++i]);
+		else if (std::strcmp(argv[i], "--max-exponent") == 0 && hasValue)
+			maxExponent = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+			jsonPath = argv[++i];
+		else if (std::strcmp(argv[i], "--verify") == 0)
+			bVerify = true;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (suites.empty())
+		suites = { Suite::Triangulation, Suite::MST, Suite::AStar, Suite::JumpPoint, Suite::Hierarchical, Suite::Bidirectional };
+	if (distributions.empty())
+		distributions = { Distribution::Uniform, Distribution::Clustered, Distribution::Collinear, Distribution::Grid };
+	if (pointCounts.empty())
+		pointCounts = { 10, 100, 1000, 10000, 100000 };
+	if (gridSides.empty())
+		gridSides = { 100, 256, 512, 1024, 2048, 4096 };
+
+	const bool bBadSize = std::any_of(pointCounts.begin(), pointCounts.end(), [](int32_t n) { return n < 3; })
+		|| std::any_of(gridSides.begin(), gridSides.end(), [](int32_t side) { return side < 2 || side > 46340; });
+	if (bBadSize || repeat <= 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (bVerify)
+	{
+		bool bFailed = false;
+		std::printf("ScalingBench: verifying the grid searches against astar, seed %d\n", seed);
+		for (Suite suite : suites)
+		{
+			if (!IsGridSuite(suite))
+				continue;
+
+			const VerifyResult result = VerifyGridSuite(suite, seed);
+			bFailed = bFailed || result.numFailures > 0;
+			std::printf("  %-14s %8d queries %8d failures   cost %+.2f%% against astar\n", SuiteNames[static_cast<size_t>(suite)], result.numQueries,
+				result.numFailures, result.referenceCost > 0.0 ? 100.0 * (result.cost / result.referenceCost - 1.0) : 0.0);
+
+			if (suite == Suite::Hierarchical)
+			{
+				const VerifyResult updates = VerifyHierarchyUpdates(seed);
+				bFailed = bFailed || updates.numFailures > 0;
+				std::printf("  %-14s %8d queries %8d failures   updated hierarchy against a fresh one\n", "hpa update", updates.numQueries,
+					updates.numFailures);
+			}
+		}
+		return bFailed ? 1 : 0;
+	}
+
+	std::printf("ScalingBench: seed %d, median of %d runs\n", seed, repeat);
+	std::printf("  %-14s %-10s %10s %14s %14s %12s\n", "suite", "dist", "n", "ms", "ns/n", "expansions");
+
+	std::vector<Result> results;
+	for (Distribution distribution : distributions)
+	{
+		const size_t first = results.size();
+		RunGraphSuites(suites, distribution, pointCounts, repeat, seed, results);
+		for (Suite suite : suites)
+		{
+			if (IsGridSuite(suite))
+				RunGridSuite(suite, distribution, gridSides, repeat, seed, results);
+		}
+
+		for (size_t i{ first }; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			std::printf("  %-14s %-10s %10lld %14.4f %14.2f", SuiteNames[static_cast<size_t>(result.suite)], DistributionNames[static_cast<size_t>(result.distribution)],
+				static_cast<long long>(result.n), result.ms, result.ms * 1e6 / result.n);
+			if (IsGridSuite(result.suite))
+				std::printf(" %12.1f", result.expansions);
+			std::printf("\n");
+		}
+	}
+
+	std::vector<Fit> fits;
+	FitExponents(results, fitFrom, fits);
+
+	bool bTooSteep = false;
+	std::printf("fits (time ~ n^k, n >= %lld):\n", static_cast<long long>(fitFrom));
+	for (const Fit& fit : fits)
+	{
+		const bool bFail = maxExponent > 0.0 && fit.exponent > maxExponent;
+		bTooSteep = bTooSteep || bFail;
+		std::printf("  %-14s %-10s k = %6.3f   r2 = %.3f   (%d sizes)%s\n", SuiteNames[static_cast<size_t>(fit.suite)], DistributionNames[static_cast<size_t>(fit.distribution)],
+			fit.exponent, fit.r2, fit.numSizes, bFail ? "   above --max-exponent" : "");
+	}
+
+	if (!jsonPath.empty() && !WriteJson(jsonPath, seed, repeat, fitFrom, results, fits))
+	{
+		std::printf("could not write %s\n", jsonPath.c_str());
+		return 1;
+	}
+	return bTooSteep ? 1 : 0;
+}